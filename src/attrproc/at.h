@@ -2,12 +2,12 @@
 #include "atdatabase.h"
 #include "atext.h"
 
+void atExprAppendOp(atExpr expr, atOpType type, double value, utSym ident);
+
 /* Lex, yacc stuff */
 extern char *atExpressionString;
-extern atContext atCurrentContext;
-extern double atCurrentValue;
+extern atExpr atCurrentExpr;
 extern uint32 atLineNum;
-extern bool atExpressionPassed;
 extern int atparse();
 extern int atlex();
 extern void aterror(char *message, ...);
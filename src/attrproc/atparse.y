@@ -22,20 +22,18 @@
 #include "at.h"
 
 char *atExpressionString;
-atContext atCurrentContext;
-double atCurrentValue;
+atExpr atCurrentExpr;
 uint32 atLineNum;
-bool atExpressionPassed;
 
 %}
 
 %union {
     double floatVal;
+    utSym symVal;
 };
 
-%token <floatVal> IDENT FLOAT
-
-%type <floatVal> expression
+%token <symVal> IDENT
+%token <floatVal> FLOAT
 
 %left '+' '-'
 %left '*' '/'
@@ -44,46 +42,37 @@ bool atExpressionPassed;
 %%
 
 goal: expression
-{
-    atCurrentValue = $1;
-}
 ;
 
 expression: '(' expression ')'
-{
-    $$ = $2;
-}
 | '{' expression '}'
-{
-    $$ = $2;
-}
 | expression '+' expression
 {
-    $$ = $1 + $3;
+    atExprAppendOp(atCurrentExpr, AT_ADD, 0.0, utSymNull);
 }
 | expression '-' expression
 {
-    $$ = $1 - $3;
+    atExprAppendOp(atCurrentExpr, AT_SUBTRACT, 0.0, utSymNull);
 }
 | expression '*' expression
 {
-    $$ = $1 * $3;
+    atExprAppendOp(atCurrentExpr, AT_MULTIPLY, 0.0, utSymNull);
 }
 | expression '/' expression
 {
-    $$ = $1 / $3;
+    atExprAppendOp(atCurrentExpr, AT_DIVIDE, 0.0, utSymNull);
 }
 | '-' expression
 {
-    $$ = -$2;
+    atExprAppendOp(atCurrentExpr, AT_NEGATE, 0.0, utSymNull);
 }
 | FLOAT
 {
-    $$ = $1;
+    atExprAppendOp(atCurrentExpr, AT_CONST, $1, utSymNull);
 }
 | IDENT
 {
-    $$ = $1;
+    atExprAppendOp(atCurrentExpr, AT_IDENT, 0.0, $1);
 }
 ;
 
@@ -20,13 +20,22 @@
   Various short-cuts and misc. routines.
 --------------------------------------------------------------------------------------------------*/
 #include <stdlib.h>
+#include <string.h>
 #include "db.h"
 #include "at.h"
+#include "htext.h"
 
 #define AT_SEP_CHARS " \t\r\n"
 
 atRoot atTheRoot;
 static utSym atSpiceTypeSym;
+static double *atStack;
+static uint32 atStackSize;
+/* Memos are hashed on the mport and the attributes of the instance context */
+static htHtbl atMemoTable;
+static dbMport atMemoMport;
+static atAttr *atMemoAttrs;
+static uint32 atMemoAttrsSize, atNumMemoAttrs;
 
 /*--------------------------------------------------------------------------------------------------
   Dump the context to the log file for debugging.
@@ -54,6 +63,11 @@ void atStart(
 {
     atTheRoot = atRootAlloc();
     atSpiceTypeSym = utSymCreate("spicetype");
+    atStackSize = 42;
+    atStack = utNewA(double, atStackSize);
+    atMemoAttrsSize = 42;
+    atMemoAttrs = utNewA(atAttr, atMemoAttrsSize);
+    atMemoTable = htHtblCreate();
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -89,32 +103,136 @@ atPin atPinCreate(
 void atStop(
     dbDesign design)
 {
+    utFree(atStack);
+    utFree(atMemoAttrs);
+    htHtblClear(atMemoTable);
+    htHtblDestroy(atMemoTable);
     atRootDestroy(atTheRoot);
 }
 
 /*--------------------------------------------------------------------------------------------------
-  Compute the value of the expression in the current context.
+  Add an instruction to the compiled expression.  The parser calls this as it reduces, so the ops
+  come out in postfix order.
+--------------------------------------------------------------------------------------------------*/
+void atExprAppendOp(
+    atExpr expr,
+    atOpType type,
+    double value,
+    utSym ident)
+{
+    uint32 numOps = atExprGetNumOps(expr);
+
+    if(numOps == atExprGetNumOp(expr)) {
+        atExprResizeOps(expr, numOps << 1);
+        atExprResizeValues(expr, numOps << 1);
+        atExprResizeIdents(expr, numOps << 1);
+    }
+    atExprSetiOp(expr, numOps, type);
+    atExprSetiValue(expr, numOps, value);
+    atExprSetiIdent(expr, numOps, ident);
+    atExprSetNumOps(expr, numOps + 1);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the compiled form of the expression.  Each distinct expression is only parsed once.  If it
+  fails to parse, it is marked invalid.
+--------------------------------------------------------------------------------------------------*/
+static atExpr compileExpression(
+    utSym expression)
+{
+    atExpr expr = atRootFindExpr(atTheRoot, expression);
+
+    if(expr != atExprNull) {
+        return expr;
+    }
+    expr = atExprAlloc();
+    atExprSetSym(expr, expression);
+    atExprAllocOps(expr, 4);
+    atExprAllocValues(expr, 4);
+    atExprAllocIdents(expr, 4);
+    atRootInsertExpr(atTheRoot, expr);
+    if(utSetjmp()) {
+        atExprSetValid(expr, false);
+        return expr;
+    }
+    atLineNum = 1;
+    atExpressionString = utSymGetName(expression);
+    atCurrentExpr = expr;
+    atExprSetValid(expr, !atparse());
+    utUnsetjmp();
+    return expr;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Compute the value of the expression in the current context.  Identifiers not set in the context
+  evaluate to 0.0, and make the expression fail.
 --------------------------------------------------------------------------------------------------*/
 static double computeExpression(
-    char *expression,
+    utSym expression,
     atContext context,
     bool *passed)
 {
-    if(utSetjmp()) {
+    atExpr expr;
+    atAttr attr;
+    uint32 numOps, xOp;
+    uint32 depth = 0;
+
+    if(expression == utSymNull) {
         *passed = false;
         return 0.0;
     }
-    atLineNum = 1;
-    atExpressionString = expression;
-    atCurrentContext = context;
-    atExpressionPassed = true;
-    if(atparse()) {
-        utUnsetjmp();
-        return false;
+    expr = compileExpression(expression);
+    if(!atExprValid(expr)) {
+        *passed = false;
+        return 0.0;
     }
-    utUnsetjmp();
-    *passed = atExpressionPassed;
-    return atCurrentValue;
+    numOps = atExprGetNumOps(expr);
+    if(numOps > atStackSize) {
+        atStackSize = numOps;
+        utResizeArray(atStack, atStackSize);
+    }
+    *passed = true;
+    for(xOp = 0; xOp < numOps; xOp++) {
+        switch(atExprGetiOp(expr, xOp)) {
+        case AT_CONST:
+            atStack[depth++] = atExprGetiValue(expr, xOp);
+            break;
+        case AT_IDENT:
+            attr = atAttrNull;
+            if(context != atContextNull) {
+                attr = atContextFindAttr(context, atExprGetiIdent(expr, xOp));
+            }
+            if(attr == atAttrNull) {
+                *passed = false;
+                atStack[depth++] = 0.0;
+            } else {
+                atStack[depth++] = atAttrGetValue(attr);
+            }
+            break;
+        case AT_ADD:
+            depth--;
+            atStack[depth - 1] += atStack[depth];
+            break;
+        case AT_SUBTRACT:
+            depth--;
+            atStack[depth - 1] -= atStack[depth];
+            break;
+        case AT_MULTIPLY:
+            depth--;
+            atStack[depth - 1] *= atStack[depth];
+            break;
+        case AT_DIVIDE:
+            depth--;
+            atStack[depth - 1] /= atStack[depth];
+            break;
+        case AT_NEGATE:
+            atStack[depth - 1] = -atStack[depth - 1];
+            break;
+        default:
+            utExit("computeExpression: Unknown op type");
+        }
+    }
+    return atStack[0];
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -148,8 +266,7 @@ static atContext findNetlistContext(
     
     databaseAttr = dbNetlistGetAttr(netlist);
     while(databaseAttr != dbAttrNull) {
-        value = computeExpression(utSymGetName(dbAttrGetValue(databaseAttr)), atContextNull,
-            &passed);
+        value = computeExpression(dbAttrGetValue(databaseAttr), atContextNull, &passed);
         if(passed) {
             attr = atAttrCreate(netlistContext, dbAttrGetName(databaseAttr), value);
         }
@@ -173,7 +290,7 @@ static atContext findInstContext(
     bool passed;
     
     while(databaseAttr != dbAttrNull) {
-        value = computeExpression(utSymGetName(dbAttrGetValue(databaseAttr)), context, &passed);
+        value = computeExpression(dbAttrGetValue(databaseAttr), context, &passed);
         if(passed) {
             attr = atAttrCreate(instContext, dbAttrGetName(databaseAttr), value);
         }
@@ -184,7 +301,7 @@ static atContext findInstContext(
     while(databaseAttr != dbAttrNull) {
         if(atContextFindAttr(instContext,
                 utSymGetLowerSym(dbAttrGetName(databaseAttr))) == atAttrNull) {
-            value = computeExpression(utSymGetName(dbAttrGetValue(databaseAttr)), context, &passed);
+            value = computeExpression(dbAttrGetValue(databaseAttr), context, &passed);
             if(passed) {
                 attr = atAttrCreate(instContext, dbAttrGetName(databaseAttr), value);
             }
@@ -194,13 +311,130 @@ static atContext findInstContext(
     return instContext;
 }
 
-static void setMportSum(dbMport mport, char *expression, atContext context, bool topLevel);
+/*--------------------------------------------------------------------------------------------------
+  Compare attributes by symbol, for qsort.
+--------------------------------------------------------------------------------------------------*/
+static int compareAttrs(
+    const void *attr1Ptr,
+    const void *attr2Ptr)
+{
+    uint32 index1 = utSym2Index(atAttrGetSym(*(atAttr *)attr1Ptr));
+    uint32 index2 = utSym2Index(atAttrGetSym(*(atAttr *)attr2Ptr));
+
+    if(index1 < index2) {
+        return -1;
+    }
+    return index1 > index2;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Hash the bits of a double.
+--------------------------------------------------------------------------------------------------*/
+static void hashDouble(
+    double value)
+{
+    uint32 words[sizeof(double)/sizeof(uint32)];
+    uint32 xWord;
+
+    memcpy(words, &value, sizeof(double));
+    for(xWord = 0; xWord < sizeof(double)/sizeof(uint32); xWord++) {
+        htHashUint32(words[xWord]);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the memo in the entry is for atMemoMport and the attributes in atMemoAttrs.
+--------------------------------------------------------------------------------------------------*/
+static bool matchMemo(
+    htEntry entry)
+{
+    atMemo memo = atIndex2Memo(htEntryGetData(entry));
+    double value, memoValue;
+    uint32 xAttr;
+
+    if(atMemoGetMport(memo) != atMemoMport || atMemoGetNumAttrs(memo) != atNumMemoAttrs) {
+        return false;
+    }
+    for(xAttr = 0; xAttr < atNumMemoAttrs; xAttr++) {
+        value = atAttrGetValue(atMemoAttrs[xAttr]);
+        memoValue = atMemoGetiAttrValue(memo, xAttr);
+        if(atMemoGetiAttrSym(memo, xAttr) != atAttrGetSym(atMemoAttrs[xAttr]) ||
+                memcmp(&memoValue, &value, sizeof(double))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the memo of the sum over the mport in the context.  The sum only depends on the attribute
+  values in the context, so they are the key, along with the mport.  The key is left in
+  atMemoMport, atMemoAttrs and htHashValue for createMemo.
+--------------------------------------------------------------------------------------------------*/
+static atMemo findMemo(
+    dbMport mport,
+    atContext context)
+{
+    htEntry entry;
+    atAttr attr;
+    uint32 xAttr;
+
+    atNumMemoAttrs = 0;
+    atForeachContextAttr(context, attr) {
+        if(atNumMemoAttrs == atMemoAttrsSize) {
+            atMemoAttrsSize <<= 1;
+            utResizeArray(atMemoAttrs, atMemoAttrsSize);
+        }
+        atMemoAttrs[atNumMemoAttrs++] = attr;
+    } atEndContextAttr;
+    qsort(atMemoAttrs, atNumMemoAttrs, sizeof(atAttr), compareAttrs);
+    atMemoMport = mport;
+    htStartHashKey();
+    htHashUint32(dbMport2Index(mport));
+    for(xAttr = 0; xAttr < atNumMemoAttrs; xAttr++) {
+        attr = atMemoAttrs[xAttr];
+        htHashSym(atAttrGetSym(attr));
+        hashDouble(atAttrGetValue(attr));
+    }
+    entry = htHtblLookupEntry(atMemoTable, matchMemo);
+    if(entry == htEntryNull) {
+        return atMemoNull;
+    }
+    return atIndex2Memo(htEntryGetData(entry));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a memo for the key left by findMemo.
+--------------------------------------------------------------------------------------------------*/
+static atMemo createMemo(void)
+{
+    atMemo memo = atMemoAlloc();
+    atAttr attr;
+    uint32 xAttr;
+
+    atMemoSetMport(memo, atMemoMport);
+    if(atNumMemoAttrs > 0) {
+        atMemoAllocAttrSyms(memo, atNumMemoAttrs);
+        atMemoAllocAttrValues(memo, atNumMemoAttrs);
+    }
+    for(xAttr = 0; xAttr < atNumMemoAttrs; xAttr++) {
+        attr = atMemoAttrs[xAttr];
+        atMemoSetiAttrSym(memo, xAttr, atAttrGetSym(attr));
+        atMemoSetiAttrValue(memo, xAttr, atAttrGetValue(attr));
+    }
+    atMemoSetNumAttrs(memo, atNumMemoAttrs);
+    atRootInsertMemo(atTheRoot, memo);
+    htHtblAdd(atMemoTable, atMemo2Index(memo));
+    return memo;
+}
+
+static void setMportSum(dbMport mport, utSym expression, atContext context, bool topLevel);
 /*--------------------------------------------------------------------------------------------------
   Just return the gate area on the port.
 --------------------------------------------------------------------------------------------------*/
 static double findPortSum(
     dbPort port,
-    char *expression,
+    utSym expression,
     atContext context)
 {
     atDevice device;
@@ -210,6 +444,7 @@ static double findPortSum(
     dbNetlist internalNetlist = dbInstGetInternalNetlist(inst);
     dbAttr deviceAttrs = dbNetlistGetAttr(internalNetlist);
     atContext instContext;
+    atMemo memo;
     utSym deviceType;
     double value;
     bool passed;
@@ -219,10 +454,17 @@ static double findPortSum(
         if(dbInstGetAttr(inst) == dbAttrNull) {
             return atMportGetSum(mport);
         }
+        /* Instances with the same parameter values share one sum */
         instContext = findInstContext(inst, context);
-        setMportSum(mport, expression, instContext, false);
+        memo = findMemo(mport, instContext);
+        if(memo == atMemoNull) {
+            /* Add the memo first, since the key is lost when setMportSum recurses */
+            memo = createMemo();
+            setMportSum(mport, expression, instContext, false);
+            atMemoSetSum(memo, atMportGetCurrentSum(mport));
+        }
         atContextDestroy(instContext);
-        return atMportGetCurrentSum(mport);
+        return atMemoGetSum(memo);
     case DB_DEVICE:
         deviceType = dbFindAttrValue(deviceAttrs, atSpiceTypeSym);
         device = atRootFindDevice(atTheRoot, utSymGetLowerSym(deviceType));
@@ -254,7 +496,7 @@ static double findPortSum(
 --------------------------------------------------------------------------------------------------*/
 static void setMportSum(
     dbMport mport,
-    char *expression,
+    utSym expression,
     atContext context,
     bool topLevel)
 {
@@ -282,7 +524,7 @@ static void setMportSum(
 --------------------------------------------------------------------------------------------------*/
 static void setNetlistSums(
     dbNetlist netlist,
-    char *expression)
+    utSym expression)
 {
     dbNetlist childNetlist;
     dbInst inst;
@@ -308,7 +550,7 @@ static void setNetlistSums(
 --------------------------------------------------------------------------------------------------*/
 static void reportNetlistSums(
     dbNetlist netlist,
-    char *expression)
+    utSym expression)
 {
     dbMport mport;
 
@@ -331,6 +573,7 @@ void atReportDesignSums(
 {
     dbNetlist netlist;
     atDevice device;
+    utSym expressionSym = utSymCreate(expression);
 
     atStart(design);
     device = atDeviceCreate(deviceType);
@@ -338,7 +581,7 @@ void atReportDesignSums(
     dbDesignClearNetlistVisitedFlags(design);
     dbForeachDesignNetlist(design, netlist) {
         if(!dbNetlistVisited(netlist) && dbNetlistGetType(netlist) == DB_SUBCIRCUIT) {
-            reportNetlistSums(netlist, expression);
+            reportNetlistSums(netlist, expressionSym);
         }
     } dbEndDesignNetlist;
     atStop(design);
@@ -385,6 +628,7 @@ void atReportDesignSumsOverPins(
     atDevice device;
     atPin pin;
     utSym deviceType, pinType;
+    utSym expressionSym = utSymCreate(expression);
     char *word = readFirstToken(pins);
 
     atStart(design);
@@ -413,7 +657,7 @@ void atReportDesignSumsOverPins(
     dbDesignClearNetlistVisitedFlags(design);
     dbForeachDesignNetlist(design, netlist) {
         if(!dbNetlistVisited(netlist) && dbNetlistGetType(netlist) == DB_SUBCIRCUIT) {
-            reportNetlistSums(netlist, expression);
+            reportNetlistSums(netlist, expressionSym);
         }
     } dbEndDesignNetlist;
     atStop(design);
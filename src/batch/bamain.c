@@ -54,6 +54,8 @@ static void usage (
        utLogMessage("%s", buff);
    }
    utLogMessage("Usage: %s [options] [tcl scripts]\n"
+      "   -a <sch file> -- Reads the schematic once, and creates SPICE, Verilog, and PCB files\n"
+      "   -A <sch file> -- Same as -a, but the SPICE top level is a subcircuit\n"
       "   -d <level> -- Sets debug level.  Valid values are 0-3\n"
       "   -c <sch file> -- Creates a top level SPICE file with a .cir extension\n"
       "   -C <sch file> -- Creates a subcircuit SPICE file with a .cir extension\n"
@@ -101,6 +103,62 @@ static char *findRcFileArgument(
     return NULL;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Read the schematic into a new current design.  Exit on errors.
+--------------------------------------------------------------------------------------------------*/
+static dbDesign readSchematic(
+    char *fileName)
+{
+    dbDesign design = schReadSchematic(utReplaceSuffix(fileName, ""), fileName, dbDesignNull);
+
+    dbRootSetCurrentDesign(dbTheRoot, design);
+    if(design == dbDesignNull) {
+        utError("Errors reading schematic %s, exiting...", fileName);
+    }
+    return design;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write the design as a SPICE netlist with a .cir extension.  This modifies the design, so it
+  must be the last writer run on it.
+--------------------------------------------------------------------------------------------------*/
+static void writeSpice(
+    dbDesign design,
+    char *fileName,
+    bool includeTopLevelPorts)
+{
+    dbRootSetIncludeTopLevelPorts(dbTheRoot, includeTopLevelPorts);
+    if(!cirWriteDesign(design, utReplaceSuffix(fileName, ".cir"), dbIncludeTopLevelPorts,
+            dbMaxLineLength, false)) {
+        utError("Errors writing spice netlist, exiting...");
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write the design as a Verilog netlist with a .v extension.
+--------------------------------------------------------------------------------------------------*/
+static void writeVerilog(
+    dbDesign design,
+    char *fileName)
+{
+    if(!vrWriteDesign(design, utReplaceSuffix(fileName, ".v"), false)) {
+        utError("Errors writing Verilog netlist, exiting...");
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write the design as a PCB netlist with a .net extension.  This explodes array instances.
+--------------------------------------------------------------------------------------------------*/
+static void writePcb(
+    dbDesign design,
+    char *fileName)
+{
+    dbDesignExplodeArrayInsts(design);
+    if(!pcbWriteDesign(design, utReplaceSuffix(fileName, ".net"))) {
+        utError("Errors writing PCB netlist, exiting...");
+    }
+}
+
 /*--------------------------------------------------------------------------------------------------
   Process arguments, performing the requested actions.
 --------------------------------------------------------------------------------------------------*/
@@ -142,17 +200,8 @@ static uint32 processArguments(
         case 'c': case 'C':
             xArg++;
             if(xArg < argc) {
-                dbCurrentDesign = schReadSchematic(utReplaceSuffix(argv[xArg], ""), argv[xArg],
-                    dbDesignNull);
-		dbRootSetCurrentDesign(dbTheRoot, dbCurrentDesign);
-                if(dbCurrentDesign == dbDesignNull) {
-                    utError("Errors reading schematic %s, exiting...", argv[xArg]);
-                }
-                dbRootSetIncludeTopLevelPorts(dbTheRoot, *optionPtr == 'C');
-                if(!cirWriteDesign(dbCurrentDesign, utReplaceSuffix(argv[xArg], ".cir"),
-                        dbIncludeTopLevelPorts, dbMaxLineLength, false)) {
-                    utError("Errors writing spice netlist, exiting...");
-                }
+                dbCurrentDesign = readSchematic(argv[xArg]);
+                writeSpice(dbCurrentDesign, argv[xArg], *optionPtr == 'C');
                 *didSomething = true;
             } else {
                 usage("Expecting .sch file after '-%s'", optionPtr);
@@ -161,15 +210,8 @@ static uint32 processArguments(
         case 'v':
             xArg++;
             if(xArg < argc) {
-                dbCurrentDesign = schReadSchematic(utReplaceSuffix(argv[xArg], ""), argv[xArg],
-                    dbDesignNull);
-		dbRootSetCurrentDesign(dbTheRoot, dbCurrentDesign);
-                if(dbCurrentDesign == dbDesignNull) {
-                    utError("Errors reading schematic %s, exiting...", argv[xArg]);
-                }
-                if(!vrWriteDesign(dbCurrentDesign, utReplaceSuffix(argv[xArg], ".v"), false)) {
-                    utError("Errors writing spice netlist, exiting...");
-                }
+                dbCurrentDesign = readSchematic(argv[xArg]);
+                writeVerilog(dbCurrentDesign, argv[xArg]);
                 *didSomething = true;
             } else {
                 usage("Expecting .sch file after '-%s'", optionPtr);
@@ -178,16 +220,23 @@ static uint32 processArguments(
         case 'p':
             xArg++;
             if(xArg < argc) {
-                dbCurrentDesign = schReadSchematic(utReplaceSuffix(argv[xArg], ""), argv[xArg],
-                    dbDesignNull);
-		dbRootSetCurrentDesign(dbTheRoot, dbCurrentDesign);
-                if(dbCurrentDesign == dbDesignNull) {
-                    utError("Errors reading schematic %s, exiting...", argv[xArg]);
-                }
-                dbDesignExplodeArrayInsts(dbCurrentDesign);
-                if(!pcbWriteDesign(dbCurrentDesign, utReplaceSuffix(argv[xArg], ".net"))) {
-                    utError("Errors writing PCB netlist, exiting...");
-                }
+                dbCurrentDesign = readSchematic(argv[xArg]);
+                writePcb(dbCurrentDesign, argv[xArg]);
+                *didSomething = true;
+            } else {
+                usage("Expecting .sch file after '-%s'", optionPtr);
+            }
+            break;
+        case 'a': case 'A':
+            /* Read the schematic once, and write each format.  Verilog output does not modify
+               the design, and the PCB writer only explodes arrays, which the SPICE writer does
+               anyway, so SPICE goes last, since it renames and merges nets. */
+            xArg++;
+            if(xArg < argc) {
+                dbCurrentDesign = readSchematic(argv[xArg]);
+                writeVerilog(dbCurrentDesign, argv[xArg]);
+                writePcb(dbCurrentDesign, argv[xArg]);
+                writeSpice(dbCurrentDesign, argv[xArg], *optionPtr == 'A');
                 *didSomething = true;
             } else {
                 usage("Expecting .sch file after '-%s'", optionPtr);
@@ -96,7 +96,10 @@ dbMport dbMportCreate(
     mport = dbMportAlloc();
     dbMportSetSym(mport, name);
     dbMportSetType(mport, type);
+    dbMportSetPosition(mport, dbNetlistGetNextMportPosition(netlist));
+    dbNetlistSetNextMportPosition(netlist, dbNetlistGetNextMportPosition(netlist) + 1);
     dbNetlistAppendMport(netlist, mport);
+    dbNetlistInvalidateHier(netlist);
     return mport;
 }
 
@@ -245,6 +248,32 @@ dbMbus dbMbusCreate(
     return mbus;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Add the port to the instance's table of ports indexed by mport position, so we can find it in
+  constant time from the mport.  Only the first port on an mport is indexed, which is the one a
+  search of the instance's ports would find.
+--------------------------------------------------------------------------------------------------*/
+void dbInstIndexPort(
+    dbInst inst,
+    dbPort port)
+{
+    uint32 position = dbMportGetPosition(dbPortGetMport(port));
+    uint32 numPorts = dbInstGetNumIndexedPort(inst);
+
+    if(position >= numPorts) {
+        numPorts = utMax(position + 1,
+            dbNetlistGetNextMportPosition(dbInstGetInternalNetlist(inst)));
+        if(dbInstGetNumIndexedPort(inst) == 0) {
+            dbInstAllocIndexedPorts(inst, numPorts);
+        } else {
+            dbInstResizeIndexedPorts(inst, numPorts);
+        }
+    }
+    if(dbInstGetiIndexedPort(inst, position) == dbPortNull) {
+        dbInstInsertIndexedPort(inst, position, port);
+    }
+}
+
 /*--------------------------------------------------------------------------------------------------
   Construct a new port object.
 --------------------------------------------------------------------------------------------------*/
@@ -256,6 +285,8 @@ dbPort dbPortCreate(
 
     dbInstAppendPort(inst, port);
     dbPortSetMport(port, mport);
+    dbInstIndexPort(inst, port);
+    dbNetlistInvalidateHier(dbInstGetNetlist(inst));
     return port;
 }
 
@@ -279,6 +310,7 @@ dbInst dbInstCreate(
     dbInstSetSym(inst, name);
     dbNetlistAppendInst(netlist, inst);
     dbNetlistAppendExternalInst(internalNetlist, inst);
+    dbNetlistInvalidateHier(netlist);
     return inst;
 }
 
@@ -344,6 +376,7 @@ dbNet dbNetCreate(
     net = dbNetAlloc();
     dbNetSetSym(net, name);
     dbNetlistAppendNet(netlist, net);
+    dbNetlistInvalidateHier(netlist);
     if(name != utSymNull) {
         global = dbDesignFindGlobal(dbNetlistGetDesign(netlist), name);
         if(global != dbGlobalNull) {
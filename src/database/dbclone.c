@@ -0,0 +1,419 @@
+/*
+ * Copyright (C) 2003 ViASIC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program; if not, write to the Free Software 
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111 USA
+ */
+
+/*--------------------------------------------------------------------------------------------------
+  Copy designs.
+
+  Objects are allocated directly rather than through their constructors, so copying does no name
+  checks, no searches for globals or flag netlists, and no re-indexing.  References between the
+  copied objects are remapped through tables indexed by the old object's index.  Objects are
+  copied in the order they are found, and every list is appended to in that order, so the copy
+  iterates just like the original.
+--------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include "db.h"
+
+static dbDesign dbCloneDesign;
+static dbGlobal *dbGlobalMap;
+static dbNetlist *dbNetlistMap;
+static dbMport *dbMportMap;
+static dbMbus *dbMbusMap;
+static dbNet *dbNetMap;
+static dbInst *dbInstMap;
+static dbPort *dbPortMap;
+
+/*--------------------------------------------------------------------------------------------------
+  Return the size a map needs to hold the index.
+--------------------------------------------------------------------------------------------------*/
+static uint32 growMapSize(
+    uint32 size,
+    uint32 index)
+{
+    return index < size? size : index + 1;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Allocate tables to map objects of the design to their copies.
+--------------------------------------------------------------------------------------------------*/
+static void allocMaps(
+    dbDesign design)
+{
+    dbGlobal global;
+    dbNetlist netlist;
+    dbMport mport;
+    dbMbus mbus;
+    dbNet net;
+    dbInst inst;
+    dbPort port;
+    uint32 numGlobals = 0, numNetlists = 0, numMports = 0, numMbuses = 0, numNets = 0;
+    uint32 numInsts = 0, numPorts = 0;
+
+    dbForeachDesignGlobal(design, global) {
+        numGlobals = growMapSize(numGlobals, dbGlobal2Index(global));
+    } dbEndDesignGlobal;
+    dbForeachDesignNetlist(design, netlist) {
+        numNetlists = growMapSize(numNetlists, dbNetlist2Index(netlist));
+        dbForeachNetlistMport(netlist, mport) {
+            numMports = growMapSize(numMports, dbMport2Index(mport));
+        } dbEndNetlistMport;
+        dbForeachNetlistMbus(netlist, mbus) {
+            numMbuses = growMapSize(numMbuses, dbMbus2Index(mbus));
+        } dbEndNetlistMbus;
+        dbForeachNetlistNet(netlist, net) {
+            numNets = growMapSize(numNets, dbNet2Index(net));
+        } dbEndNetlistNet;
+        dbForeachNetlistInst(netlist, inst) {
+            numInsts = growMapSize(numInsts, dbInst2Index(inst));
+            dbForeachInstPort(inst, port) {
+                numPorts = growMapSize(numPorts, dbPort2Index(port));
+            } dbEndInstPort;
+        } dbEndNetlistInst;
+    } dbEndDesignNetlist;
+    dbGlobalMap = utNewA(dbGlobal, numGlobals + 1);
+    dbNetlistMap = utNewA(dbNetlist, numNetlists + 1);
+    dbMportMap = utNewA(dbMport, numMports + 1);
+    dbMbusMap = utNewA(dbMbus, numMbuses + 1);
+    dbNetMap = utNewA(dbNet, numNets + 1);
+    dbInstMap = utNewA(dbInst, numInsts + 1);
+    dbPortMap = utNewA(dbPort, numPorts + 1);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Free the object maps.
+--------------------------------------------------------------------------------------------------*/
+static void freeMaps(void)
+{
+    utFree(dbGlobalMap);
+    utFree(dbNetlistMap);
+    utFree(dbMportMap);
+    utFree(dbMbusMap);
+    utFree(dbNetMap);
+    utFree(dbInstMap);
+    utFree(dbPortMap);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the copy of a netlist.  Netlists of other designs, such as libraries, are shared.
+--------------------------------------------------------------------------------------------------*/
+static dbNetlist mapNetlist(
+    dbNetlist netlist)
+{
+    if(dbNetlistGetDesign(netlist) != dbCloneDesign) {
+        return netlist;
+    }
+    return dbNetlistMap[dbNetlist2Index(netlist)];
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the copy of an mport.  Mports of netlists in other designs are shared.
+--------------------------------------------------------------------------------------------------*/
+static dbMport mapMport(
+    dbMport mport)
+{
+    if(dbNetlistGetDesign(dbMportGetNetlist(mport)) != dbCloneDesign) {
+        return mport;
+    }
+    return dbMportMap[dbMport2Index(mport)];
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Copy the unique name counters.
+--------------------------------------------------------------------------------------------------*/
+static dbPrefix copyPrefix(
+    dbPrefix prefix)
+{
+    dbPrefix newPrefix = dbPrefixAlloc();
+
+    dbPrefixSetSym(newPrefix, dbPrefixGetSym(prefix));
+    dbPrefixSetNextNetSuffix(newPrefix, dbPrefixGetNextNetSuffix(prefix));
+    dbPrefixSetNextInstSuffix(newPrefix, dbPrefixGetNextInstSuffix(prefix));
+    dbPrefixSetNextMportSuffix(newPrefix, dbPrefixGetNextMportSuffix(prefix));
+    dbPrefixSetNextNetlistSuffix(newPrefix, dbPrefixGetNextNetlistSuffix(prefix));
+    dbPrefixSetNextGlobalSuffix(newPrefix, dbPrefixGetNextGlobalSuffix(prefix));
+    return newPrefix;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Copy the design's globals, prefixes, and library cells.
+--------------------------------------------------------------------------------------------------*/
+static void copyDesignObjects(
+    dbDesign design,
+    dbDesign newDesign)
+{
+    dbGlobal global, newGlobal;
+    dbPrefix prefix;
+    dbLibcell libcell, newLibcell;
+    uint32 numPorts, xPort;
+
+    dbForeachDesignGlobal(design, global) {
+        newGlobal = dbGlobalAlloc();
+        dbGlobalSetSym(newGlobal, dbGlobalGetSym(global));
+        dbDesignAppendGlobal(newDesign, newGlobal);
+        dbGlobalMap[dbGlobal2Index(global)] = newGlobal;
+    } dbEndDesignGlobal;
+    global = dbDesignGetZeroGlobal(design);
+    if(global != dbGlobalNull) {
+        dbDesignSetZeroGlobal(newDesign, dbGlobalMap[dbGlobal2Index(global)]);
+    }
+    global = dbDesignGetOneGlobal(design);
+    if(global != dbGlobalNull) {
+        dbDesignSetOneGlobal(newDesign, dbGlobalMap[dbGlobal2Index(global)]);
+    }
+    dbForeachDesignPrefix(design, prefix) {
+        dbDesignAppendPrefix(newDesign, copyPrefix(prefix));
+    } dbEndDesignPrefix;
+    dbForeachDesignLibcell(design, libcell) {
+        newLibcell = dbLibcellAlloc();
+        dbLibcellSetSym(newLibcell, dbLibcellGetSym(libcell));
+        dbLibcellSetOffset(newLibcell, dbLibcellGetOffset(libcell));
+        dbLibcellSetLineNum(newLibcell, dbLibcellGetLineNum(libcell));
+        dbLibcellSetPending(newLibcell, dbLibcellPending(libcell));
+        numPorts = dbLibcellGetNumPortSym(libcell);
+        if(numPorts > 0) {
+            dbLibcellResizePortSyms(newLibcell, numPorts);
+            for(xPort = 0; xPort < numPorts; xPort++) {
+                dbLibcellSetiPortSym(newLibcell, xPort, dbLibcellGetiPortSym(libcell, xPort));
+            }
+        }
+        dbDesignAppendLibcell(newDesign, newLibcell);
+    } dbEndDesignLibcell;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Copy the netlist, but not its contents.
+--------------------------------------------------------------------------------------------------*/
+static void copyNetlist(
+    dbDesign newDesign,
+    dbNetlist netlist)
+{
+    dbNetlist newNetlist = dbNetlistAlloc();
+    dbPrefix prefix;
+
+    dbNetlistSetSym(newNetlist, dbNetlistGetSym(netlist));
+    dbNetlistSetType(newNetlist, dbNetlistGetType(netlist));
+    dbNetlistSetDevice(newNetlist, dbNetlistGetDevice(netlist));
+    dbNetlistSetNextMportPosition(newNetlist, dbNetlistGetNextMportPosition(netlist));
+    dbNetlistSetAttr(newNetlist, dbCopyAttrs(dbNetlistGetAttr(netlist)));
+    dbDesignAppendNetlist(newDesign, newNetlist);
+    dbForeachNetlistPrefix(netlist, prefix) {
+        dbNetlistAppendPrefix(newNetlist, copyPrefix(prefix));
+    } dbEndNetlistPrefix;
+    dbNetlistMap[dbNetlist2Index(netlist)] = newNetlist;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Copy the netlist's mports, mbuses, nets and buses.  These are what instances of the netlist, and
+  instances in it, refer to.
+--------------------------------------------------------------------------------------------------*/
+static void copyNetlistSignals(
+    dbNetlist netlist)
+{
+    dbNetlist newNetlist = dbNetlistMap[dbNetlist2Index(netlist)];
+    dbMport mport, newMport;
+    dbMbus mbus, newMbus;
+    dbNet net, newNet;
+    dbBus bus, newBus;
+    uint32 numBits, xBit;
+
+    dbForeachNetlistMport(netlist, mport) {
+        newMport = dbMportAlloc();
+        dbMportSetSym(newMport, dbMportGetSym(mport));
+        dbMportSetType(newMport, dbMportGetType(mport));
+        dbMportSetPosition(newMport, dbMportGetPosition(mport));
+        dbMportSetAttr(newMport, dbCopyAttrs(dbMportGetAttr(mport)));
+        dbNetlistAppendMport(newNetlist, newMport);
+        dbMportMap[dbMport2Index(mport)] = newMport;
+    } dbEndNetlistMport;
+    dbForeachNetlistMbus(netlist, mbus) {
+        newMbus = dbMbusAlloc();
+        dbMbusSetSym(newMbus, dbMbusGetSym(mbus));
+        dbMbusSetType(newMbus, dbMbusGetType(mbus));
+        dbMbusSetLeft(newMbus, dbMbusGetLeft(mbus));
+        dbMbusSetRight(newMbus, dbMbusGetRight(mbus));
+        dbNetlistAppendMbus(newNetlist, newMbus);
+        numBits = dbMbusGetNumMport(mbus);
+        if(numBits > 0) {
+            dbMbusAllocMports(newMbus, numBits);
+            for(xBit = 0; xBit < numBits; xBit++) {
+                mport = dbMbusGetiMport(mbus, xBit);
+                if(mport != dbMportNull) {
+                    dbMbusInsertMport(newMbus, xBit, dbMportMap[dbMport2Index(mport)]);
+                }
+            }
+        }
+        dbMbusMap[dbMbus2Index(mbus)] = newMbus;
+    } dbEndNetlistMbus;
+    dbForeachNetlistNet(netlist, net) {
+        newNet = dbNetAlloc();
+        dbNetSetSym(newNet, dbNetGetSym(net));
+        dbNetSetAttr(newNet, dbCopyAttrs(dbNetGetAttr(net)));
+        dbNetlistAppendNet(newNetlist, newNet);
+        dbNetMap[dbNet2Index(net)] = newNet;
+    } dbEndNetlistNet;
+    dbForeachNetlistBus(netlist, bus) {
+        newBus = dbBusAlloc();
+        dbBusSetSym(newBus, dbBusGetSym(bus));
+        dbBusSetLeft(newBus, dbBusGetLeft(bus));
+        dbBusSetRight(newBus, dbBusGetRight(bus));
+        dbNetlistAppendBus(newNetlist, newBus);
+        numBits = dbBusGetNumNet(bus);
+        if(numBits > 0) {
+            dbBusAllocNets(newBus, numBits);
+            for(xBit = 0; xBit < numBits; xBit++) {
+                net = dbBusGetiNet(bus, xBit);
+                if(net != dbNetNull) {
+                    dbBusInsertNet(newBus, xBit, dbNetMap[dbNet2Index(net)]);
+                }
+            }
+        }
+    } dbEndNetlistBus;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Copy the netlist's instances and their ports.
+--------------------------------------------------------------------------------------------------*/
+static void copyNetlistInsts(
+    dbNetlist netlist)
+{
+    dbNetlist newNetlist = dbNetlistMap[dbNetlist2Index(netlist)];
+    dbNetlist internalNetlist;
+    dbInst inst, newInst;
+    dbMbus mbus, newMbus;
+    dbPort port, newPort;
+    uint32 numPorts, xPort;
+
+    dbForeachNetlistInst(netlist, inst) {
+        newInst = dbInstAlloc();
+        dbInstSetSym(newInst, dbInstGetSym(inst));
+        dbInstSetArray(newInst, dbInstArray(inst));
+        dbInstSetAttr(newInst, dbCopyAttrs(dbInstGetAttr(inst)));
+        dbNetlistAppendInst(newNetlist, newInst);
+        internalNetlist = dbInstGetInternalNetlist(inst);
+        if(dbNetlistGetDesign(internalNetlist) != dbCloneDesign) {
+            /* Copies of instances of the design's own netlists are linked in order later */
+            dbNetlistAppendExternalInst(internalNetlist, newInst);
+        }
+        mbus = dbInstGetExternalMbus(inst);
+        if(mbus != dbMbusNull) {
+            newMbus = dbMbusMap[dbMbus2Index(mbus)];
+            dbInstSetExternalMbus(newInst, newMbus);
+            dbMbusSetFlagInst(newMbus, newInst);
+        }
+        dbForeachInstPort(inst, port) {
+            newPort = dbPortAlloc();
+            dbPortSetMport(newPort, mapMport(dbPortGetMport(port)));
+            dbInstAppendPort(newInst, newPort);
+            dbPortMap[dbPort2Index(port)] = newPort;
+        } dbEndInstPort;
+        numPorts = dbInstGetNumIndexedPort(inst);
+        if(numPorts > 0) {
+            dbInstAllocIndexedPorts(newInst, numPorts);
+            for(xPort = 0; xPort < numPorts; xPort++) {
+                port = dbInstGetiIndexedPort(inst, xPort);
+                if(port != dbPortNull) {
+                    dbInstInsertIndexedPort(newInst, xPort, dbPortMap[dbPort2Index(port)]);
+                }
+            }
+        }
+        dbInstMap[dbInst2Index(inst)] = newInst;
+    } dbEndNetlistInst;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Link the copied ports to nets, and flag ports to mports, in the original order.
+--------------------------------------------------------------------------------------------------*/
+static void linkNetlistPorts(
+    dbNetlist netlist)
+{
+    dbNetlist newNetlist = dbNetlistMap[dbNetlist2Index(netlist)];
+    dbMport mport;
+    dbNet net, newNet;
+    dbInst inst;
+    dbPort port;
+
+    dbForeachNetlistNet(netlist, net) {
+        newNet = dbNetMap[dbNet2Index(net)];
+        dbForeachNetPort(net, port) {
+            dbNetAppendPort(newNet, dbPortMap[dbPort2Index(port)]);
+        } dbEndNetPort;
+    } dbEndNetlistNet;
+    dbForeachNetlistMport(netlist, mport) {
+        port = dbMportGetFlagPort(mport);
+        if(port != dbPortNull) {
+            dbMportSetFlagPort(dbMportMap[dbMport2Index(mport)], dbPortMap[dbPort2Index(port)]);
+        }
+    } dbEndNetlistMport;
+    dbForeachNetlistExternalInst(netlist, inst) {
+        if(dbNetlistGetDesign(dbInstGetNetlist(inst)) == dbCloneDesign) {
+            dbNetlistAppendExternalInst(newNetlist, dbInstMap[dbInst2Index(inst)]);
+        }
+    } dbEndNetlistExternalInst;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Make a copy of the design, with the new name.  The copy shares the original's library.  Hier
+  objects are not copied.
+--------------------------------------------------------------------------------------------------*/
+dbDesign dbDesignClone(
+    dbDesign design,
+    utSym name)
+{
+    dbDesign libraryDesign = dbDesignGetLibraryDesign(design);
+    dbDesign newDesign = dbDesignAlloc();
+    uint32 nameLength = dbDesignGetNumLazyFileName(design);
+    dbNetlist netlist;
+    dbGlobal global;
+    dbNet net;
+
+    dbCloneDesign = design;
+    dbDesignSetSym(newDesign, name);
+    dbRootInsertDesign(dbTheRoot, newDesign);
+    if(libraryDesign != dbDesignNull) {
+        dbDesignInsertLinkedDesign(libraryDesign, newDesign);
+    }
+    dbDesignSetAttr(newDesign, dbCopyAttrs(dbDesignGetAttr(design)));
+    if(nameLength > 0) {
+        dbDesignResizeLazyFileNames(newDesign, nameLength);
+        memcpy(dbDesignGetLazyFileName(newDesign), dbDesignGetLazyFileName(design), nameLength);
+    }
+    allocMaps(design);
+    copyDesignObjects(design, newDesign);
+    dbForeachDesignNetlist(design, netlist) {
+        copyNetlist(newDesign, netlist);
+    } dbEndDesignNetlist;
+    netlist = dbDesignGetRootNetlist(design);
+    if(netlist != dbNetlistNull) {
+        dbDesignSetRootNetlist(newDesign, dbNetlistMap[dbNetlist2Index(netlist)]);
+    }
+    dbForeachDesignNetlist(design, netlist) {
+        copyNetlistSignals(netlist);
+    } dbEndDesignNetlist;
+    dbForeachDesignNetlist(design, netlist) {
+        copyNetlistInsts(netlist);
+    } dbEndDesignNetlist;
+    dbForeachDesignNetlist(design, netlist) {
+        linkNetlistPorts(netlist);
+    } dbEndDesignNetlist;
+    dbForeachDesignGlobal(design, global) {
+        dbForeachGlobalNet(global, net) {
+            dbGlobalAppendNet(dbGlobalMap[dbGlobal2Index(global)], dbNetMap[dbNet2Index(net)]);
+        } dbEndGlobalNet;
+    } dbEndDesignGlobal;
+    freeMaps();
+    return newDesign;
+}
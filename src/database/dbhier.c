@@ -0,0 +1,801 @@
+/*
+ * Copyright (C) 2003 ViASIC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program; if not, write to the Free Software 
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111 USA
+ */
+
+/*--------------------------------------------------------------------------------------------------
+  Flat views of hierarchical designs.
+
+  A Hier object summarizes one netlist as it would be flattened: how many devices and nets each
+  occurrence of it holds, and where each instance's share starts.  Since every occurrence of a
+  netlist is the same, one Hier per netlist covers all of them, and the size of this occurrence
+  tree does not depend on the flat size of the design.
+
+  Devices are instances of device netlists, and of sub-circuits with no devices of their own, such
+  as black boxes.  An occurrence owns its nets except those joined to a parent's net through an
+  mport, and global nets, which the design owns.  Numbering devices and owned nets depth first
+  gives each one a path id.  A dbHierPath holds the instances on the way down to one of them, so
+  iterating moves the path rather than building flat objects.
+
+  Creating or destroying an instance, net, port or mport in a netlist with a Hier destroys its Hier
+  and those of the netlists above it, in whatever design they are, so the flat views that hold it
+  are built again the next time they are needed.
+--------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include "db.h"
+
+/*--------------------------------------------------------------------------------------------------
+  Destroy the Hier of the netlist, and those of every netlist instantiating it, up to the tops of
+  the flat views that hold it.  Library netlists are shared by designs, so this crosses designs.
+  A netlist has a Hier whenever one of the netlists above it does, so edits outside any flat view
+  cost nothing.
+--------------------------------------------------------------------------------------------------*/
+void dbNetlistInvalidateHier(
+    dbNetlist netlist)
+{
+    dbHier hier = dbNetlistGetHier(netlist);
+    dbInst inst;
+
+    if(hier == dbHierNull) {
+        return;
+    }
+    dbHierDestroy(hier);
+    dbForeachNetlistExternalInst(netlist, inst) {
+        dbNetlistInvalidateHier(dbInstGetNetlist(inst));
+    } dbEndNetlistExternalInst;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Invalidate the flat view when an instance is destroyed, since its Hier may list the instance.
+--------------------------------------------------------------------------------------------------*/
+static void instDestroyed(
+    dbInst inst)
+{
+    dbNetlist netlist = dbInstGetNetlist(inst);
+
+    if(netlist != dbNetlistNull) {
+        dbNetlistInvalidateHier(netlist);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Invalidate the flat view when a net is destroyed.
+--------------------------------------------------------------------------------------------------*/
+static void netDestroyed(
+    dbNet net)
+{
+    dbNetlist netlist = dbNetGetNetlist(net);
+
+    if(netlist != dbNetlistNull) {
+        dbNetlistInvalidateHier(netlist);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Invalidate the flat view when a port is destroyed, since the nets it joins through an mport are
+  not owned by the occurrence.
+--------------------------------------------------------------------------------------------------*/
+static void portDestroyed(
+    dbPort port)
+{
+    dbInst inst = dbPortGetInst(port);
+
+    if(inst != dbInstNull && dbInstGetNetlist(inst) != dbNetlistNull) {
+        dbNetlistInvalidateHier(dbInstGetNetlist(inst));
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Invalidate the flat view when an mport is destroyed.
+--------------------------------------------------------------------------------------------------*/
+static void mportDestroyed(
+    dbMport mport)
+{
+    dbNetlist netlist = dbMportGetNetlist(mport);
+
+    if(netlist != dbNetlistNull) {
+        dbNetlistInvalidateHier(netlist);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Watch for destroyed instances, nets, ports and mports.
+--------------------------------------------------------------------------------------------------*/
+void dbHierStart(void)
+{
+    dbInstSetDestructorCallback(instDestroyed);
+    dbNetSetDestructorCallback(netDestroyed);
+    dbPortSetDestructorCallback(portDestroyed);
+    dbMportSetDestructorCallback(mportDestroyed);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the net is owned by an occurrence of its netlist.  At the top, mport nets are owned
+  too, since there is no parent to own them.
+--------------------------------------------------------------------------------------------------*/
+static bool netIsOwned(
+    dbNet net,
+    bool atTop)
+{
+    if(dbNetGetGlobal(net) != dbGlobalNull) {
+        return false;
+    }
+    return atTop || dbNetFindMport(net) == dbMportNull;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the instance is flattened into its netlist's contents.
+--------------------------------------------------------------------------------------------------*/
+bool dbInstIsHier(
+    dbInst inst)
+{
+    dbNetlist internalNetlist = dbInstGetInternalNetlist(inst);
+    dbHier hier;
+
+    if(dbNetlistGetType(internalNetlist) != DB_SUBCIRCUIT) {
+        return false;
+    }
+    hier = dbNetlistGetHier(internalNetlist);
+    return hier != dbHierNull && dbHierGetNumDevices(hier) > 0;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the instance is a flat device.
+--------------------------------------------------------------------------------------------------*/
+static bool instIsDevice(
+    dbInst inst)
+{
+    dbNetlistType type = dbInstGetType(inst);
+
+    return type == DB_DEVICE || (type == DB_SUBCIRCUIT && !dbInstIsHier(inst));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the Hier for the netlist, after those of the netlists it instantiates.
+--------------------------------------------------------------------------------------------------*/
+static dbHier buildHier(
+    dbNetlist netlist)
+{
+    dbHier hier = dbNetlistGetHier(netlist);
+    dbHier childHier;
+    dbNetlist internalNetlist;
+    dbInst inst;
+    dbNet net;
+    uint64 numDevices = 0, numNets = 0;
+    uint32 numInsts = 0, numLocalNets = 0;
+
+    if(hier != dbHierNull) {
+        if(!dbHierBuilt(hier)) {
+            utError("Netlist %s instantiates itself", dbNetlistGetName(netlist));
+        }
+        return hier;
+    }
+    hier = dbHierAlloc();
+    dbNetlistSetHier(netlist, hier);
+    dbForeachNetlistInst(netlist, inst) {
+        internalNetlist = dbInstGetInternalNetlist(inst);
+        if(dbNetlistGetType(internalNetlist) == DB_SUBCIRCUIT) {
+            buildHier(internalNetlist);
+        }
+        if(instIsDevice(inst) || dbInstIsHier(inst)) {
+            numInsts++;
+        }
+    } dbEndNetlistInst;
+    dbForeachNetlistNet(netlist, net) {
+        if(netIsOwned(net, false)) {
+            numLocalNets++;
+        }
+    } dbEndNetlistNet;
+    numNets = numLocalNets;
+    if(numInsts > 0) {
+        dbHierAllocInsts(hier, numInsts);
+        dbHierAllocDeviceOffsets(hier, numInsts);
+        dbHierAllocNetOffsets(hier, numInsts);
+    }
+    numInsts = 0;
+    dbForeachNetlistInst(netlist, inst) {
+        if(instIsDevice(inst) || dbInstIsHier(inst)) {
+            dbHierInsertInst(hier, numInsts, inst);
+            dbHierSetiDeviceOffset(hier, numInsts, numDevices);
+            dbHierSetiNetOffset(hier, numInsts, numNets);
+            if(dbInstIsHier(inst)) {
+                childHier = dbNetlistGetHier(dbInstGetInternalNetlist(inst));
+                numDevices += dbHierGetNumDevices(childHier);
+                numNets += dbHierGetNumNets(childHier);
+            } else {
+                numDevices++;
+            }
+            numInsts++;
+        }
+    } dbEndNetlistInst;
+    dbHierSetNumDevices(hier, numDevices);
+    dbHierSetNumNets(hier, numNets);
+    dbHierSetNumLocalNets(hier, numLocalNets);
+    dbHierSetBuilt(hier, true);
+    return hier;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Destroy the Hiers of the netlist and those below it.
+--------------------------------------------------------------------------------------------------*/
+static void destroyHiers(
+    dbNetlist netlist)
+{
+    dbHier hier = dbNetlistGetHier(netlist);
+    dbInst inst;
+
+    if(hier == dbHierNull) {
+        return;
+    }
+    dbHierDestroy(hier);
+    dbForeachNetlistInst(netlist, inst) {
+        destroyHiers(dbInstGetInternalNetlist(inst));
+    } dbEndNetlistInst;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the flat view of the design, replacing any old one.
+--------------------------------------------------------------------------------------------------*/
+dbHier dbDesignBuildHier(
+    dbDesign design)
+{
+    dbNetlist rootNetlist = dbDesignGetRootNetlist(design);
+
+    if(rootNetlist == dbNetlistNull) {
+        return dbHierNull;
+    }
+    destroyHiers(rootNetlist);
+    return buildHier(rootNetlist);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the design's flat view, building it if needed.  Creating or destroying instances, nets,
+  ports or mports below the root netlist destroys the old one.
+--------------------------------------------------------------------------------------------------*/
+dbHier dbDesignFindHier(
+    dbDesign design)
+{
+    dbNetlist rootNetlist = dbDesignGetRootNetlist(design);
+    dbHier hier;
+
+    if(rootNetlist == dbNetlistNull) {
+        return dbHierNull;
+    }
+    hier = dbNetlistGetHier(rootNetlist);
+    if(hier == dbHierNull) {
+        hier = dbDesignBuildHier(design);
+    }
+    return hier;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Count the global nets of the design that have nets.  These come first when numbering flat nets.
+--------------------------------------------------------------------------------------------------*/
+static uint32 countFlatGlobals(
+    dbDesign design)
+{
+    dbGlobal global;
+    uint32 numGlobals = 0;
+
+    dbForeachDesignGlobal(design, global) {
+        if(dbGlobalGetFirstNet(global) != dbNetNull) {
+            numGlobals++;
+        }
+    } dbEndDesignGlobal;
+    return numGlobals;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Count the nets the root netlist owns beyond its Hier's local nets: those on its mports.
+--------------------------------------------------------------------------------------------------*/
+static uint32 countTopMportNets(
+    dbNetlist netlist)
+{
+    dbNet net;
+    uint32 numNets = 0;
+
+    dbForeachNetlistNet(netlist, net) {
+        if(netIsOwned(net, true) && !netIsOwned(net, false)) {
+            numNets++;
+        }
+    } dbEndNetlistNet;
+    return numNets;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Count the flat devices of the design.
+--------------------------------------------------------------------------------------------------*/
+uint64 dbDesignGetNumFlatDevices(
+    dbDesign design)
+{
+    dbHier hier = dbDesignFindHier(design);
+
+    if(hier == dbHierNull) {
+        return 0;
+    }
+    return dbHierGetNumDevices(hier);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Count the flat nets of the design, including global nets.
+--------------------------------------------------------------------------------------------------*/
+uint64 dbDesignGetNumFlatNets(
+    dbDesign design)
+{
+    dbHier hier = dbDesignFindHier(design);
+
+    if(hier == dbHierNull) {
+        return 0;
+    }
+    return countFlatGlobals(design) + countTopMportNets(dbDesignGetRootNetlist(design)) +
+        dbHierGetNumNets(hier);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a path at the top of the design.  The design's flat view must be built.
+--------------------------------------------------------------------------------------------------*/
+dbHierPath dbHierPathCreate(
+    dbDesign design)
+{
+    dbHierPath path = utNew(struct dbHierPathStruct);
+
+    path->design = design;
+    path->top = dbDesignGetRootNetlist(design);
+    path->depth = 0;
+    path->maxDepth = 16;
+    path->insts = utNewA(dbInst, path->maxDepth);
+    path->positions = utNewA(uint32, path->maxDepth);
+    path->nameSize = 256;
+    path->name = utNewA(char, path->nameSize);
+    return path;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Free a path.
+--------------------------------------------------------------------------------------------------*/
+void dbHierPathFree(
+    dbHierPath path)
+{
+    utFree(path->insts);
+    utFree(path->positions);
+    utFree(path->name);
+    utFree(path);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Make the path the same as another one.
+--------------------------------------------------------------------------------------------------*/
+void dbHierPathCopy(
+    dbHierPath path,
+    dbHierPath source)
+{
+    uint32 xLevel;
+
+    path->depth = 0;
+    for(xLevel = 0; xLevel < source->depth; xLevel++) {
+        dbHierPathPush(path, source->insts[xLevel], source->positions[xLevel]);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add an instance to the end of the path.  Position is its index in its netlist's Hier.
+--------------------------------------------------------------------------------------------------*/
+void dbHierPathPush(
+    dbHierPath path,
+    dbInst inst,
+    uint32 position)
+{
+    if(path->depth == path->maxDepth) {
+        path->maxDepth <<= 1;
+        utResizeArray(path->insts, path->maxDepth);
+        utResizeArray(path->positions, path->maxDepth);
+    }
+    path->insts[path->depth] = inst;
+    path->positions[path->depth] = position;
+    path->depth++;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Remove the instance at the end of the path, and return it.  Return dbInstNull if the path is at
+  the top.
+--------------------------------------------------------------------------------------------------*/
+dbInst dbHierPathPop(
+    dbHierPath path)
+{
+    if(path->depth == 0) {
+        return dbInstNull;
+    }
+    path->depth--;
+    return path->insts[path->depth];
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the netlist the path leads into.
+--------------------------------------------------------------------------------------------------*/
+dbNetlist dbHierPathGetNetlist(
+    dbHierPath path)
+{
+    if(path->depth == 0) {
+        return path->top;
+    }
+    return dbInstGetInternalNetlist(path->insts[path->depth - 1]);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the netlist holding the instance at the level.
+--------------------------------------------------------------------------------------------------*/
+static dbNetlist findLevelNetlist(
+    dbHierPath path,
+    uint32 level)
+{
+    if(level == 0) {
+        return path->top;
+    }
+    return dbInstGetInternalNetlist(path->insts[level - 1]);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Extend the path from the instance at its end down to the first device below it.
+--------------------------------------------------------------------------------------------------*/
+static void descendToDevice(
+    dbHierPath path)
+{
+    dbInst inst = path->insts[path->depth - 1];
+    dbHier hier;
+
+    while(dbInstIsHier(inst)) {
+        hier = dbNetlistGetHier(dbInstGetInternalNetlist(inst));
+        inst = dbHierGetiInst(hier, 0);
+        dbHierPathPush(path, inst, 0);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Move the path to the first flat device.  Return false if there are none.
+--------------------------------------------------------------------------------------------------*/
+bool dbHierPathFirstDevice(
+    dbHierPath path)
+{
+    dbHier hier = dbNetlistGetHier(path->top);
+
+    path->depth = 0;
+    if(hier == dbHierNull || dbHierGetNumDevices(hier) == 0) {
+        return false;
+    }
+    dbHierPathPush(path, dbHierGetiInst(hier, 0), 0);
+    descendToDevice(path);
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Move the path to the next flat device.  Return false after the last one.
+--------------------------------------------------------------------------------------------------*/
+bool dbHierPathNextDevice(
+    dbHierPath path)
+{
+    dbHier hier;
+    uint32 position;
+
+    while(path->depth > 0) {
+        path->depth--;
+        hier = dbNetlistGetHier(findLevelNetlist(path, path->depth));
+        position = path->positions[path->depth] + 1;
+        if(position < dbHierGetNumInst(hier)) {
+            dbHierPathPush(path, dbHierGetiInst(hier, position), position);
+            descendToDevice(path);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Get the instance at the end of the path, which is the device when iterating devices.
+--------------------------------------------------------------------------------------------------*/
+dbInst dbHierPathGetInst(
+    dbHierPath path)
+{
+    if(path->depth == 0) {
+        return dbInstNull;
+    }
+    return path->insts[path->depth - 1];
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the last instance whose range of numbers holds the number.  Empty ranges never come last.
+--------------------------------------------------------------------------------------------------*/
+static uint32 findOffsetPosition(
+    dbHier hier,
+    uint64 number,
+    bool nets)
+{
+    uint32 low = 0;
+    uint32 high = dbHierGetNumInst(hier);
+    uint32 middle;
+    uint64 offset;
+
+    while(high - low > 1) {
+        middle = low + ((high - low) >> 1);
+        offset = nets? dbHierGetiNetOffset(hier, middle) : dbHierGetiDeviceOffset(hier, middle);
+        if(offset <= number) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Move the path to the flat device with the number.  Return false if there is no such device.
+--------------------------------------------------------------------------------------------------*/
+bool dbHierPathSetDevice(
+    dbHierPath path,
+    uint64 number)
+{
+    dbHier hier = dbNetlistGetHier(path->top);
+    dbInst inst;
+    uint32 position;
+
+    path->depth = 0;
+    if(hier == dbHierNull || number >= dbHierGetNumDevices(hier)) {
+        return false;
+    }
+    utDo {
+        position = findOffsetPosition(hier, number, false);
+        number -= dbHierGetiDeviceOffset(hier, position);
+        inst = dbHierGetiInst(hier, position);
+        dbHierPathPush(path, inst, position);
+    } utWhile(dbInstIsHier(inst)) {
+        hier = dbNetlistGetHier(dbInstGetInternalNetlist(inst));
+    } utRepeat;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the first net at or after the net that the occurrence at the end of the path owns.
+--------------------------------------------------------------------------------------------------*/
+static dbNet findOwnedNet(
+    dbHierPath path,
+    dbNet net)
+{
+    while(net != dbNetNull && !netIsOwned(net, path->depth == 0)) {
+        net = dbNetGetNextNetlistNet(net);
+    }
+    return net;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Move the path to the next occurrence with owned nets, depth first.  Return false after the last.
+--------------------------------------------------------------------------------------------------*/
+static bool nextNetOccurrence(
+    dbHierPath path)
+{
+    dbHier hier = dbNetlistGetHier(dbHierPathGetNetlist(path));
+    uint32 position = 0;
+    dbInst inst;
+
+    utDo {
+        while(position < dbHierGetNumInst(hier)) {
+            inst = dbHierGetiInst(hier, position);
+            if(dbInstIsHier(inst) &&
+                    dbHierGetNumNets(dbNetlistGetHier(dbInstGetInternalNetlist(inst))) > 0) {
+                dbHierPathPush(path, inst, position);
+                return true;
+            }
+            position++;
+        }
+    } utWhile(path->depth > 0) {
+        path->depth--;
+        position = path->positions[path->depth] + 1;
+        hier = dbNetlistGetHier(findLevelNetlist(path, path->depth));
+    } utRepeat;
+    return false;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Move the path to the occurrence owning the first flat net that is not global, and return the
+  net.  Global nets are the design's globals.
+--------------------------------------------------------------------------------------------------*/
+dbNet dbHierPathFirstNet(
+    dbHierPath path)
+{
+    dbNet net;
+
+    path->depth = 0;
+    if(dbNetlistGetHier(path->top) == dbHierNull) {
+        return dbNetNull;
+    }
+    net = findOwnedNet(path, dbNetlistGetFirstNet(path->top));
+    if(net != dbNetNull) {
+        return net;
+    }
+    return dbHierPathNextNet(path, dbNetNull);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Move to the next flat net that is not global.  Return dbNetNull after the last one.
+--------------------------------------------------------------------------------------------------*/
+dbNet dbHierPathNextNet(
+    dbHierPath path,
+    dbNet net)
+{
+    if(net != dbNetNull) {
+        net = findOwnedNet(path, dbNetGetNextNetlistNet(net));
+    }
+    while(net == dbNetNull) {
+        if(!nextNetOccurrence(path)) {
+            return dbNetNull;
+        }
+        net = findOwnedNet(path, dbNetlistGetFirstNet(dbHierPathGetNetlist(path)));
+    }
+    return net;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the numberth net that the occurrence at the end of the path owns.  Return dbNetNull if it
+  owns fewer nets, which can only happen if the flat view is out of date.
+--------------------------------------------------------------------------------------------------*/
+static dbNet findNthOwnedNet(
+    dbHierPath path,
+    uint64 number)
+{
+    dbNet net = findOwnedNet(path, dbNetlistGetFirstNet(dbHierPathGetNetlist(path)));
+
+    while(number > 0 && net != dbNetNull) {
+        net = findOwnedNet(path, dbNetGetNextNetlistNet(net));
+        number--;
+    }
+    return net;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Move the path to the occurrence owning the flat net with the number, and return the net.  If it
+  is a global net, the path is left at the top, and the first net on the global is returned.
+--------------------------------------------------------------------------------------------------*/
+dbNet dbHierPathSetNet(
+    dbHierPath path,
+    uint64 number)
+{
+    dbHier hier = dbNetlistGetHier(path->top);
+    dbGlobal global;
+    dbInst inst;
+    uint32 position;
+    uint32 numTopNets;
+
+    path->depth = 0;
+    if(hier == dbHierNull) {
+        return dbNetNull;
+    }
+    dbForeachDesignGlobal(path->design, global) {
+        if(dbGlobalGetFirstNet(global) != dbNetNull) {
+            if(number == 0) {
+                return dbGlobalGetFirstNet(global);
+            }
+            number--;
+        }
+    } dbEndDesignGlobal;
+    numTopNets = countTopMportNets(path->top) + dbHierGetNumLocalNets(hier);
+    if(number < numTopNets) {
+        return findNthOwnedNet(path, number);
+    }
+    number -= numTopNets;
+    if(number >= dbHierGetNumNets(hier) - dbHierGetNumLocalNets(hier)) {
+        return dbNetNull;
+    }
+    number += dbHierGetNumLocalNets(hier);
+    while(number >= dbHierGetNumLocalNets(hier)) {
+        position = findOffsetPosition(hier, number, true);
+        number -= dbHierGetiNetOffset(hier, position);
+        inst = dbHierGetiInst(hier, position);
+        dbHierPathPush(path, inst, position);
+        hier = dbNetlistGetHier(dbInstGetInternalNetlist(inst));
+    }
+    return findNthOwnedNet(path, number);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Trace the net in the occurrence at the end of the path up through mports to the occurrence that
+  owns it.  The path is moved up to that occurrence, and the owner's net is returned.  Global nets
+  are returned as they are.  A net on an mport that the parent instance leaves unconnected is
+  owned where it is, but is not numbered.
+--------------------------------------------------------------------------------------------------*/
+dbNet dbHierPathTraceNet(
+    dbHierPath path,
+    dbNet net)
+{
+    dbMport mport;
+    dbPort port;
+
+    while(path->depth > 0 && dbNetGetGlobal(net) == dbGlobalNull) {
+        mport = dbNetFindMport(net);
+        if(mport == dbMportNull) {
+            return net;
+        }
+        port = dbFindPortFromInstMport(path->insts[path->depth - 1], mport);
+        if(port == dbPortNull || dbPortGetNet(port) == dbNetNull) {
+            return net;
+        }
+        net = dbPortGetNet(port);
+        path->depth--;
+    }
+    return net;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Make sure the path's name buffer can hold the length.
+--------------------------------------------------------------------------------------------------*/
+static void growName(
+    dbHierPath path,
+    uint32 length)
+{
+    if(length > path->nameSize) {
+        path->nameSize = length + (length >> 1);
+        utResizeArray(path->name, path->nameSize);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the flat name of the path's instances, joined by the separator.  The name is kept in the
+  path, and is good until the path's name is built again.
+--------------------------------------------------------------------------------------------------*/
+char *dbHierPathGetName(
+    dbHierPath path,
+    char separator)
+{
+    char *name;
+    uint32 length = 0;
+    uint32 nameLength, xLevel;
+
+    path->name[0] = '\0';
+    for(xLevel = 0; xLevel < path->depth; xLevel++) {
+        name = utSymGetName(dbInstGetSym(path->insts[xLevel]));
+        nameLength = strlen(name);
+        growName(path, length + nameLength + 2);
+        if(xLevel > 0) {
+            path->name[length++] = separator;
+        }
+        memcpy(path->name + length, name, nameLength + 1);
+        length += nameLength;
+    }
+    return path->name;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the flat name of a net owned by the occurrence at the end of the path.
+--------------------------------------------------------------------------------------------------*/
+char *dbHierPathGetNetName(
+    dbHierPath path,
+    dbNet net,
+    char separator)
+{
+    dbGlobal global = dbNetGetGlobal(net);
+    char *name = dbNetGetName(net);
+    uint32 length, nameLength;
+
+    if(global != dbGlobalNull) {
+        return dbGlobalGetName(global);
+    }
+    if(path->depth == 0) {
+        return name;
+    }
+    length = strlen(dbHierPathGetName(path, separator));
+    nameLength = strlen(name);
+    growName(path, length + nameLength + 2);
+    path->name[length++] = separator;
+    memcpy(path->name + length, name, nameLength + 1);
+    return path->name;
+}
@@ -20,8 +20,25 @@
   Top level database functions.
 --------------------------------------------------------------------------------------------------*/
 #include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include "db.h"
 
+/* Binary snapshots start with this header.  The DataDraw tables that follow are raw field arrays
+   with no description of their layout, so bump the version whenever the header or any .dd
+   schema changes, or old snapshots would be loaded into the wrong fields.
+     1: First version */
+#define DB_SNAPSHOT_MAGIC "GNETMANS"
+#define DB_SNAPSHOT_MAGIC_LENGTH 8
+#define DB_SNAPSHOT_VERSION 1
+#define DB_SNAPSHOT_ENDIAN_CHECK 0x01020304
+#define DB_SNAPSHOT_HEADER_LENGTH (DB_SNAPSHOT_MAGIC_LENGTH + 2*sizeof(uint32))
+#define DB_SNAPSHOT_BUFFER_SIZE (1 << 22)
+
 dbRoot dbTheRoot;
 utSym dbGraphicalSym;
 
@@ -64,11 +81,18 @@ void dbStart(void)
     strcpy(dbGschemComponentPath, ".");
     dbRootAllocGschemSourcePaths(dbTheRoot, 2);
     strcpy(dbGschemSourcePath, ".");
+    dbRootAllocSymbolCacheFiles(dbTheRoot, 1);
+    strcpy(dbSymbolCacheFile, "");
     dbRootSetSpiceTarget(dbTheRoot, DB_LTSPICE);
     dbRootSetCurrentDesign(dbTheRoot, dbDesignNull);
     dbRootSetCurrentLibrary(dbTheRoot, dbDesignNull);
     dbRootSetCurrentNetlist(dbTheRoot, dbNetlistNull);
     dbRootSetLibraryWins(dbTheRoot, false);
+    dbRootSetLazyLibraries(dbTheRoot, false);
+    dbRootSetNumThreads(dbTheRoot, 4);
+    dbRootSetPreserveDesign(dbTheRoot, false);
+    dbRootSetFlatSpice(dbTheRoot, false);
+    dbRootSetStreamVerilog(dbTheRoot, false);
     /* Set a reasonable default SPICE string, in case there's no config file */
     dbDevspecCreate(utSymCreate("ltspice"), DB_LTSPICE, dbDefaultSpiceDeviceString);
     dbDevspecCreate(utSymCreate("tclspice"), DB_TCLSPICE, "");
@@ -82,6 +106,7 @@ void dbStart(void)
     geRES250Sym = utSymCreate("RES250");
     geRES6KSym = utSymCreate("RES6K");
     dbShortStart();
+    dbHierStart();
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -93,3 +118,138 @@ void dbStop(void)
     dbDatabaseStop();
 }
 
+
+/*--------------------------------------------------------------------------------------------------
+  Write the database object tables to a binary snapshot file.  Each field of each class is
+  written as one array, so we use a large stdio buffer to keep the writes big and sequential.
+--------------------------------------------------------------------------------------------------*/
+bool dbSaveSnapshot(
+    char *fileName)
+{
+    FILE *file = fopen(fileName, "wb");
+    char *buffer;
+    uint32 version = DB_SNAPSHOT_VERSION;
+    uint32 endianCheck = DB_SNAPSHOT_ENDIAN_CHECK;
+
+    if(file == NULL) {
+        utWarning("Unable to open file %s for writing", fileName);
+        return false;
+    }
+    buffer = utNewA(char, DB_SNAPSHOT_BUFFER_SIZE);
+    setvbuf(file, buffer, _IOFBF, DB_SNAPSHOT_BUFFER_SIZE);
+    fwrite(DB_SNAPSHOT_MAGIC, sizeof(char), DB_SNAPSHOT_MAGIC_LENGTH, file);
+    fwrite(&version, sizeof(uint32), 1, file);
+    fwrite(&endianCheck, sizeof(uint32), 1, file);
+    utSaveBinaryDatabase(file);
+    fclose(file);
+    utFree(buffer);
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Check the snapshot header.
+--------------------------------------------------------------------------------------------------*/
+static bool snapshotHeaderIsValid(
+    char *fileName,
+    char *header)
+{
+    uint32 version, endianCheck;
+
+    if(strncmp(header, DB_SNAPSHOT_MAGIC, DB_SNAPSHOT_MAGIC_LENGTH)) {
+        utWarning("File %s is not a gnetman database snapshot", fileName);
+        return false;
+    }
+    memcpy(&version, header + DB_SNAPSHOT_MAGIC_LENGTH, sizeof(uint32));
+    memcpy(&endianCheck, header + DB_SNAPSHOT_MAGIC_LENGTH + sizeof(uint32), sizeof(uint32));
+    if(endianCheck != DB_SNAPSHOT_ENDIAN_CHECK) {
+        utWarning("Database snapshot %s was written on a machine with different byte order",
+            fileName);
+        return false;
+    }
+    if(version != DB_SNAPSHOT_VERSION) {
+        utWarning("Database snapshot %s has version %u, but we need version %u", fileName,
+            version, DB_SNAPSHOT_VERSION);
+        return false;
+    }
+    return true;
+}
+
+#ifndef _WIN32
+/*--------------------------------------------------------------------------------------------------
+  Load the database object tables from a binary snapshot file.  The file is mapped into memory,
+  and the tables are read from the mapping, so nothing is parsed, and each table is filled with
+  one block copy.  The caller must reset any global object handles afterwards.
+--------------------------------------------------------------------------------------------------*/
+bool dbLoadSnapshot(
+    char *fileName)
+{
+    struct stat fileStat;
+    FILE *file;
+    char *data;
+    int fd = open(fileName, O_RDONLY);
+
+    if(fd < 0) {
+        utWarning("Unable to open file %s for reading", fileName);
+        return false;
+    }
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t)DB_SNAPSHOT_HEADER_LENGTH) {
+        utWarning("File %s is not a gnetman database snapshot", fileName);
+        close(fd);
+        return false;
+    }
+    data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        utWarning("Unable to map file %s into memory", fileName);
+        return false;
+    }
+    madvise(data, fileStat.st_size, MADV_SEQUENTIAL);
+    if(!snapshotHeaderIsValid(fileName, data)) {
+        munmap(data, fileStat.st_size);
+        return false;
+    }
+    file = fmemopen(data + DB_SNAPSHOT_HEADER_LENGTH,
+        fileStat.st_size - DB_SNAPSHOT_HEADER_LENGTH, "rb");
+    if(file == NULL) {
+        utWarning("Unable to read mapped file %s", fileName);
+        munmap(data, fileStat.st_size);
+        return false;
+    }
+    utLoadBinaryDatabase(file);
+    fclose(file);
+    munmap(data, fileStat.st_size);
+    return true;
+}
+#else
+/*--------------------------------------------------------------------------------------------------
+  Load the database object tables from a binary snapshot file.  Without mmap, we just read it
+  through a large stdio buffer.  The caller must reset any global object handles afterwards.
+--------------------------------------------------------------------------------------------------*/
+bool dbLoadSnapshot(
+    char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    char header[DB_SNAPSHOT_HEADER_LENGTH];
+    char *buffer;
+
+    if(file == NULL) {
+        utWarning("Unable to open file %s for reading", fileName);
+        return false;
+    }
+    if(fread(header, sizeof(char), DB_SNAPSHOT_HEADER_LENGTH, file) != DB_SNAPSHOT_HEADER_LENGTH) {
+        utWarning("File %s is not a gnetman database snapshot", fileName);
+        fclose(file);
+        return false;
+    }
+    if(!snapshotHeaderIsValid(fileName, header)) {
+        fclose(file);
+        return false;
+    }
+    buffer = utNewA(char, DB_SNAPSHOT_BUFFER_SIZE);
+    setvbuf(file, buffer, _IOFBF, DB_SNAPSHOT_BUFFER_SIZE);
+    utLoadBinaryDatabase(file);
+    fclose(file);
+    utFree(buffer);
+    return true;
+}
+#endif
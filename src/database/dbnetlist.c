@@ -212,7 +212,7 @@ void dbDesignConvertPowerInstsToGlobals(
 /*--------------------------------------------------------------------------------------------------
   Find the name for one bit of an array of instances.
 --------------------------------------------------------------------------------------------------*/
-static utSym findArrayInstName(
+utSym dbFindArrayInstName(
     dbInst arrayInst,
     uint32 xInst)
 {
@@ -285,19 +285,23 @@ static uint32 findPortWidth(
 }
 
 /*--------------------------------------------------------------------------------------------------
-  Build the ports on the new bit instance of an instance array.
+  Find the ports of an instance array that connect to one bit of it, in the order that bit's
+  instance gets its ports.  The bit instance's port for ports[x] is on mports[x], and is on the
+  same net.  Both arrays must have room for every port of the array instance.  Return the number
+  of ports found.
 --------------------------------------------------------------------------------------------------*/
-static void buildArrayInstPorts(
+uint32 dbFindArrayInstBitPorts(
     dbInst arrayInst,
-    dbInst inst,
     uint32 portPosition,
-    uint32 instWidth)
+    uint32 instWidth,
+    dbPort *ports,
+    dbMport *mports)
 {
     dbPort oldPort = dbInstGetFirstPort(arrayInst);
-    dbPort newPort;
     dbMbus mbus;
     dbMport mport;
     uint32 xPort, busWidth;
+    uint32 numPorts = 0;
     bool busExploded;
 
     while(oldPort != dbPortNull) {
@@ -305,8 +309,8 @@ static void buildArrayInstPorts(
         mbus = dbMportGetMbus(mport);
         if(mbus == dbMbusNull && portIsBus(oldPort)) {
             oldPort = skipPorts(oldPort, portPosition);
-            newPort = dbPortCreate(inst, mport);
-            dbNetInsertPort(dbPortGetNet(oldPort), newPort);
+            ports[numPorts] = oldPort;
+            mports[numPorts++] = mport;
             oldPort = skipPorts(oldPort, instWidth - portPosition);
         } else if(mbus != dbMbusNull) {
             busWidth = utAbs((int32)dbMbusGetRight(mbus) - (int32)dbMbusGetLeft(mbus)) + 1;
@@ -315,20 +319,49 @@ static void buildArrayInstPorts(
                 oldPort = skipPorts(oldPort, portPosition*busWidth);
             }
             for(xPort = 0; xPort < busWidth; xPort++) {
-                mport = dbPortGetMport(oldPort);
-                newPort = dbPortCreate(inst, mport);
-                dbNetInsertPort(dbPortGetNet(oldPort), newPort);
+                ports[numPorts] = oldPort;
+                mports[numPorts++] = dbPortGetMport(oldPort);
                 oldPort = dbPortGetNextInstPort(oldPort);
             }
             if(busExploded) {
                 oldPort = skipPortPastMbus(oldPort, mbus);
             }
         } else {
-            newPort = dbPortCreate(inst, mport);
-            dbNetInsertPort(dbPortGetNet(oldPort), newPort);
+            ports[numPorts] = oldPort;
+            mports[numPorts++] = mport;
             oldPort = dbPortGetNextInstPort(oldPort);
         }
     }
+    return numPorts;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the ports on the new bit instance of an instance array.
+--------------------------------------------------------------------------------------------------*/
+static void buildArrayInstPorts(
+    dbInst arrayInst,
+    dbInst inst,
+    uint32 portPosition,
+    uint32 instWidth)
+{
+    dbPort port;
+    uint32 numPorts = 0;
+    dbPort *ports;
+    dbMport *mports;
+    uint32 xPort;
+
+    dbForeachInstPort(arrayInst, port) {
+        numPorts++;
+    } dbEndInstPort;
+    ports = utNewA(dbPort, numPorts + 1);
+    mports = utNewA(dbMport, numPorts + 1);
+    numPorts = dbFindArrayInstBitPorts(arrayInst, portPosition, instWidth, ports, mports);
+    for(xPort = 0; xPort < numPorts; xPort++) {
+        port = dbPortCreate(inst, mports[xPort]);
+        dbNetInsertPort(dbPortGetNet(ports[xPort]), port);
+    }
+    utFree(ports);
+    utFree(mports);
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -341,7 +374,7 @@ static dbInst buildOneInstOfArray(
     uint32 instWidth)
 {
     dbNetlist internalNetlist = dbInstGetInternalNetlist(arrayInst);
-    utSym name = findArrayInstName(arrayInst, xInst);
+    utSym name = dbFindArrayInstName(arrayInst, xInst);
     dbInst inst = dbInstCreate(dbInstGetNetlist(arrayInst), name, internalNetlist);
 
     dbInstSetAttr(inst, dbCopyAttrs(dbInstGetAttr(arrayInst)));
@@ -351,6 +384,7 @@ static dbInst buildOneInstOfArray(
 
 /*--------------------------------------------------------------------------------------------------
   Explode an array instance into individual non-array instances.  Note that this destroys the inst.
+  The new instances index their ports by mport as dbPortCreate builds them.
 --------------------------------------------------------------------------------------------------*/
 void dbInstExplode(
     dbInst inst)
@@ -417,7 +451,7 @@ static bool nameContainsNonAlnumChars(
 /*--------------------------------------------------------------------------------------------------
   Replace all non-alphanumeric characters with '_', except for any trailing non-alnum char.
 --------------------------------------------------------------------------------------------------*/
-static char *mungeName(
+char *dbMungeName(
     char *name)
 {
     char *newName = utMakeString(strlen(name) + 42); /* Note: hard-wired 42 is bigger than needed */
@@ -445,7 +479,7 @@ static void mungeInstName(
 {
     dbNetlist netlist = dbInstGetNetlist(inst);
     char *name = dbInstGetName(inst);
-    char *newName = mungeName(name);
+    char *newName = dbMungeName(name);
     utSym sym;
 
     dbNetlistRenameInst(netlist, inst, utSymNull);
@@ -476,7 +510,7 @@ static void mungeNetName(
 {
     dbNetlist netlist = dbNetGetNetlist(net);
     char *name = dbNetGetName(net);
-    char *newName = mungeName(name);
+    char *newName = dbMungeName(name);
     utSym sym;
 
     dbNetlistRenameNet(netlist, net, utSymNull);
@@ -505,7 +539,7 @@ static void mungeMportName(
 {
     dbNetlist netlist = dbMportGetNetlist(mport);
     char *name = dbMportGetName(mport);
-    char *newName = mungeName(name);
+    char *newName = dbMungeName(name);
     utSym sym;
 
     dbNetlistRenameMport(netlist, mport, utSymNull);
@@ -547,7 +581,7 @@ static void mungeNetlistName(
 {
     dbDesign design = dbNetlistGetDesign(netlist);
     char *name = dbNetlistGetName(netlist);
-    char *newName = mungeName(name);
+    char *newName = dbMungeName(name);
     utSym sym;
 
     dbDesignRenameNetlist(design, netlist, utSymNull);
@@ -576,7 +610,7 @@ static void mungeGlobalName(
 {
     dbDesign design = dbGlobalGetDesign(global);
     char *name = dbGlobalGetName(global);
-    char *newName = mungeName(name);
+    char *newName = dbMungeName(name);
     utSym sym;
 
     dbDesignRenameGlobal(design, global, utSymNull);
@@ -652,6 +686,27 @@ void dbDesignBuildNetsForFloatingPorts(
     } dbEndDesignNetlist;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Rebuild the instance's table of ports indexed by mport position, after the mports on its ports
+  have changed.
+--------------------------------------------------------------------------------------------------*/
+static void reindexInstPorts(
+    dbInst inst)
+{
+    dbPort port;
+    uint32 xPort;
+
+    for(xPort = 0; xPort < dbInstGetNumIndexedPort(inst); xPort++) {
+        port = dbInstGetiIndexedPort(inst, xPort);
+        if(port != dbPortNull) {
+            dbInstRemoveIndexedPort(inst, port);
+        }
+    }
+    dbForeachInstPort(inst, port) {
+        dbInstIndexPort(inst, port);
+    } dbEndInstPort;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Replace the internal netlist of an inst.  Port names must match exactly.
 --------------------------------------------------------------------------------------------------*/
@@ -673,6 +728,7 @@ void dbInstReplaceInternalNetlist(
         }
         dbPortSetMport(port, newMport);
     } dbEndInstPort;
+    reindexInstPorts(inst);
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -23,20 +23,40 @@
 #include "db.h"
 
 /*--------------------------------------------------------------------------------------------------
-  Find the port on the inst from it's owning mport.
+  Find the port on the inst from it's owning mport.  Ports are indexed by mport position when
+  they are created, so this is a constant time lookup.
 --------------------------------------------------------------------------------------------------*/
 dbPort dbFindPortFromInstMport(
     dbInst inst,
     dbMport mport)
 {
+    uint32 position = dbMportGetPosition(mport);
     dbPort port;
 
-    dbForeachInstPort(inst, port) {
-        if(dbPortGetMport(port) == mport) {
-            return port;
+    if(position >= dbInstGetNumIndexedPort(inst)) {
+        return dbPortNull;
+    }
+    port = dbInstGetiIndexedPort(inst, position);
+    if(port == dbPortNull || dbPortGetMport(port) != mport) {
+        return dbPortNull;
+    }
+    return port;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the mport the net connects to through a flag instance, if any.
+--------------------------------------------------------------------------------------------------*/
+dbMport dbNetFindMport(
+    dbNet net)
+{
+    dbPort port;
+
+    dbForeachNetPort(net, port) {
+        if(dbInstGetType(dbPortGetInst(port)) == DB_FLAG) {
+            return dbPortGetMport(port);
         }
-    } dbEndInstPort;
-    return dbPortNull;
+    } dbEndNetPort;
+    return dbMportNull;
 }
 
 /*--------------------------------------------------------------------------------------------------
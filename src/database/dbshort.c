@@ -199,8 +199,43 @@ char *dbPortGetName(
     return utSprintf("%s.%s", dbInstGetUserName(inst), dbMportGetName(mport));
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Find the unique name counters for the prefix in the netlist.  Create them if they don't exist.
+--------------------------------------------------------------------------------------------------*/
+static dbPrefix findOrCreateNetlistPrefix(
+    dbNetlist netlist,
+    utSym sym)
+{
+    dbPrefix prefix = dbNetlistFindPrefix(netlist, sym);
+
+    if(prefix == dbPrefixNull) {
+        prefix = dbPrefixAlloc();
+        dbPrefixSetSym(prefix, sym);
+        dbNetlistInsertPrefix(netlist, prefix);
+    }
+    return prefix;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the unique name counters for the prefix in the design.  Create them if they don't exist.
+--------------------------------------------------------------------------------------------------*/
+static dbPrefix findOrCreateDesignPrefix(
+    dbDesign design,
+    utSym sym)
+{
+    dbPrefix prefix = dbDesignFindPrefix(design, sym);
+
+    if(prefix == dbPrefixNull) {
+        prefix = dbPrefixAlloc();
+        dbPrefixSetSym(prefix, sym);
+        dbDesignInsertPrefix(design, prefix);
+    }
+    return prefix;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Create a unique net name in the schematic.  Make sure it does not collide with a global.
+  Suffixes are counted per prefix, so we don't re-probe names we've already handed out.
 --------------------------------------------------------------------------------------------------*/
 utSym dbNetlistCreateUniqueNetName(
     dbNetlist netlist,
@@ -208,17 +243,20 @@ utSym dbNetlistCreateUniqueNetName(
 {
     dbDesign design = dbNetlistGetDesign(netlist);
     utSym sym = utSymCreate(name);
-    uint32 x = 0;
+    dbPrefix prefix;
+    uint32 x;
 
+    if(dbNetlistFindNet(netlist, sym) == dbNetNull) {
+        return sym;
+    }
+    prefix = findOrCreateNetlistPrefix(netlist, sym);
+    x = dbPrefixGetNextNetSuffix(prefix);
     do {
-        if(dbNetlistFindNet(netlist, sym) == dbNetNull) {
-            return sym;
-        }
-        do {
-            sym = utSymCreateFormatted("%s%u", name, x);
-            x++;
-        } while(dbNetlistFindNet(netlist, sym) != dbNetNull);
-    } while(dbDesignFindGlobal(design, sym) != dbGlobalNull);
+        sym = utSymCreateFormatted("%s%u", name, x);
+        x++;
+    } while(dbNetlistFindNet(netlist, sym) != dbNetNull ||
+        dbDesignFindGlobal(design, sym) != dbGlobalNull);
+    dbPrefixSetNextNetSuffix(prefix, x);
     return sym;
 }
 
@@ -230,15 +268,19 @@ utSym dbNetlistCreateUniqueInstName(
     char *name)
 {
     utSym sym = utSymCreate(name);
-    uint32 x = 0;
+    dbPrefix prefix;
+    uint32 x;
 
     if(dbNetlistFindInst(netlist, sym) == dbInstNull) {
         return sym;
     }
+    prefix = findOrCreateNetlistPrefix(netlist, sym);
+    x = dbPrefixGetNextInstSuffix(prefix);
     do {
         sym = utSymCreateFormatted("%s%u", name, x);
         x++;
     } while(dbNetlistFindInst(netlist, sym) != dbInstNull);
+    dbPrefixSetNextInstSuffix(prefix, x);
     return sym;
 }
 
@@ -250,15 +292,19 @@ utSym dbNetlistCreateUniqueMportName(
     char *name)
 {
     utSym sym = utSymCreate(name);
-    uint32 x = 0;
+    dbPrefix prefix;
+    uint32 x;
 
     if(dbNetlistFindMport(netlist, sym) == dbMportNull) {
         return sym;
     }
+    prefix = findOrCreateNetlistPrefix(netlist, sym);
+    x = dbPrefixGetNextMportSuffix(prefix);
     do {
         sym = utSymCreateFormatted("%s%u", name, x);
         x++;
     } while(dbNetlistFindMport(netlist, sym) != dbMportNull);
+    dbPrefixSetNextMportSuffix(prefix, x);
     return sym;
 }
 
@@ -270,15 +316,19 @@ utSym dbDesignCreateUniqueNetlistName(
     char *name)
 {
     utSym sym = utSymCreate(name);
-    uint32 x = 0;
+    dbPrefix prefix;
+    uint32 x;
 
     if(dbDesignFindNetlist(design, sym) == dbNetlistNull) {
         return sym;
     }
+    prefix = findOrCreateDesignPrefix(design, sym);
+    x = dbPrefixGetNextNetlistSuffix(prefix);
     do {
         sym = utSymCreateFormatted("%s%u", name, x);
         x++;
     } while(dbDesignFindNetlist(design, sym) != dbNetlistNull);
+    dbPrefixSetNextNetlistSuffix(prefix, x);
     return sym;
 }
 
@@ -290,15 +340,19 @@ utSym dbDesignCreateUniqueGlobalName(
     char *name)
 {
     utSym sym = utSymCreate(name);
-    uint32 x = 0;
+    dbPrefix prefix;
+    uint32 x;
 
     if(dbDesignFindGlobal(design, sym) == dbGlobalNull) {
         return sym;
     }
+    prefix = findOrCreateDesignPrefix(design, sym);
+    x = dbPrefixGetNextGlobalSuffix(prefix);
     do {
         sym = utSymCreateFormatted("%s%u", name, x);
         x++;
     } while(dbDesignFindGlobal(design, sym) != dbGlobalNull);
+    dbPrefixSetNextGlobalSuffix(prefix, x);
     return sym;
 }
 
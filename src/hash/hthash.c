@@ -156,6 +156,24 @@ htEntry htHtblLookupEntry(
     return htEntryNull;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Find the next entry after this one in the same hash bucket that also matches.  This is used to
+  visit every entry with the same key, after the first is found with htHtblLookupEntry.
+--------------------------------------------------------------------------------------------------*/
+htEntry htHtblLookupNextEntry(
+    htEntry entry,
+    bool (*matchEntry)(htEntry entry))
+{
+    entry = htEntryGetEntry(entry);
+    while(entry != htEntryNull) {
+        if(matchEntry(entry)) {
+            return entry;
+        }
+        entry = htEntryGetEntry(entry);
+    }
+    return htEntryNull;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Find a value in the hash table with the given name.
 --------------------------------------------------------------------------------------------------*/
@@ -250,6 +268,27 @@ void htDeleteHtblEntry(
     htHtblSetNumEntries(htbl, htHtblGetNumEntries(htbl) - 1);
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Free all the entries in the hash table, leaving it empty, but keeping its current size.
+--------------------------------------------------------------------------------------------------*/
+void htHtblClear(
+    htHtbl htbl)
+{
+    uint32 size = 1 << htHtblGetSizeExp(htbl);
+    htEntry entry, nEntry;
+    uint32 xEntry;
+
+    for(xEntry = 0; xEntry < size; xEntry++) {
+        for(entry = htHtblGetiEntry(htbl, xEntry); entry != htEntryNull; entry = nEntry) {
+            nEntry = htEntryGetEntry(entry);
+            htEntrySetEntry(entry, htEntryNull);
+            htEntryFree(entry);
+        }
+        htHtblSetiEntry(htbl, xEntry, htEntryNull);
+    }
+    htHtblSetNumEntries(htbl, 0);
+}
+
 /*--------------------------------------------------------------------------------------------------
   Add a symbol to the hash table.
 --------------------------------------------------------------------------------------------------*/
@@ -19,4 +19,4 @@
 bool cirWriteDesign(dbDesign design, char *fileName, bool includeTopLevelPorts, uint32 maxLineLength,
     bool wholeLibrary);
 dbDesign cirReadDesign(char *designName, char *fileName, dbDesign libDesign);
-
+dbDesign cirIndexLibrary(char *libraryName, char *fileName, dbDesign libDesign);
@@ -30,13 +30,17 @@ void dbStart(void);
 void dbStop(void);
 void dbShortStart(void);
 void dbShortStop(void);
+bool dbSaveSnapshot(char *fileName);
+bool dbLoadSnapshot(char *fileName);
 
 /* Constructors */
 dbDesign dbDesignCreate(utSym name, dbDesign libraryDesign);
+dbDesign dbDesignClone(dbDesign design, utSym name);
 dbNetlist dbNetlistCreate(dbDesign design, utSym name, dbNetlistType type, utSym device);
 dbMport dbMportCreate(dbNetlist netlist, utSym name, dbMportType type);
 dbMbus dbMbusCreate(dbNetlist netlist, utSym name, dbMportType type, uint32 left, uint32 right);
 dbPort dbPortCreate(dbInst inst, dbMport mport);
+void dbInstIndexPort(dbInst inst, dbPort port);
 dbInst dbInstCreate(dbNetlist netlist, utSym name, dbNetlist internalNetlist);
 dbInst dbJoinInstCreate(dbNetlist netlist);
 void dbJoinInstAddNet(dbInst join, dbNet net);
@@ -95,6 +99,7 @@ bool dbNameHasRange(char *name, uint32 *left, uint32 *right);
 
 /* Queries */
 dbPort dbFindPortFromInstMport(dbInst inst, dbMport mport);
+dbMport dbNetFindMport(dbNet net);
 utSym dbFindAttrValue(dbAttr attr, utSym name);
 dbAttr dbFindAttr(dbAttr attr, utSym name);
 dbAttr dbFindAttrNoCase(dbAttr attr, utSym name);
@@ -117,8 +122,12 @@ void dbDesignConvertPowerInstsToGlobals(dbDesign design);
 void dbDesignExplodeArrayInsts(dbDesign design);
 void dbNetlistExplodeArrayInsts(dbNetlist netlist);
 void dbInstExplode(dbInst inst);
+utSym dbFindArrayInstName(dbInst arrayInst, uint32 xInst);
+uint32 dbFindArrayInstBitPorts(dbInst arrayInst, uint32 portPosition, uint32 instWidth,
+    dbPort *ports, dbMport *mports);
 void dbDesignEliminateNonAlnumChars(dbDesign design);
 void dbNetlistEliminateNonAlnumChars(dbNetlist netlist);
+char *dbMungeName(char *name);
 void dbInstReplaceInternalNetlist(dbInst inst, dbNetlist newInternalNetlist);
 void dbBusHookup(dbBus bus, dbPort firstPort);
 extern void dbThreadGlobalsThroughHierarchy(dbDesign design, bool createTopLevelPorts);
@@ -127,6 +136,41 @@ void dbMergeNetIntoNet(dbNet sourceNet, dbNet destNet);
 dbMport dbMbusIndexMport(dbMbus mbus, uint32 bit);
 dbNet dbBusIndexNet(dbBus bus, uint32 bit);
 
+/* Flat views of designs, built on Hier.  See dbhier.c */
+typedef struct dbHierPathStruct {
+    dbDesign design;
+    dbNetlist top;
+    dbInst *insts;
+    uint32 *positions;
+    uint32 depth, maxDepth;
+    char *name;
+    uint32 nameSize;
+} *dbHierPath;
+
+void dbHierStart(void);
+void dbNetlistInvalidateHier(dbNetlist netlist);
+dbHier dbDesignBuildHier(dbDesign design);
+dbHier dbDesignFindHier(dbDesign design);
+uint64 dbDesignGetNumFlatDevices(dbDesign design);
+uint64 dbDesignGetNumFlatNets(dbDesign design);
+bool dbInstIsHier(dbInst inst);
+dbHierPath dbHierPathCreate(dbDesign design);
+void dbHierPathFree(dbHierPath path);
+void dbHierPathCopy(dbHierPath path, dbHierPath source);
+void dbHierPathPush(dbHierPath path, dbInst inst, uint32 position);
+dbInst dbHierPathPop(dbHierPath path);
+dbNetlist dbHierPathGetNetlist(dbHierPath path);
+dbInst dbHierPathGetInst(dbHierPath path);
+bool dbHierPathFirstDevice(dbHierPath path);
+bool dbHierPathNextDevice(dbHierPath path);
+bool dbHierPathSetDevice(dbHierPath path, uint64 number);
+dbNet dbHierPathFirstNet(dbHierPath path);
+dbNet dbHierPathNextNet(dbHierPath path, dbNet net);
+dbNet dbHierPathSetNet(dbHierPath path, uint64 number);
+dbNet dbHierPathTraceNet(dbHierPath path, dbNet net);
+char *dbHierPathGetName(dbHierPath path, char separator);
+char *dbHierPathGetNetName(dbHierPath path, dbNet net, char separator);
+
 extern dbRoot dbTheRoot;
 
 /*#define dbCurrentDesign dbRootGetCurrentDesign(dbTheRoot)*/
@@ -140,6 +184,12 @@ extern dbRoot dbTheRoot;
 #define dbMaxLineLength dbRootGetMaxLineLength(dbTheRoot)
 #define dbIncludeTopLevelPorts dbRootIncludeTopLevelPorts(dbTheRoot)
 #define dbLibraryWins dbRootLibraryWins(dbTheRoot)
+#define dbLazyLibraries dbRootLazyLibraries(dbTheRoot)
+#define dbNumThreads dbRootGetNumThreads(dbTheRoot)
+#define dbSymbolCacheFile dbRootGetSymbolCacheFile(dbTheRoot)
+#define dbPreserveDesign dbRootPreserveDesign(dbTheRoot)
+#define dbFlatSpice dbRootFlatSpice(dbTheRoot)
+#define dbStreamVerilog dbRootStreamVerilog(dbTheRoot)
 
 /* Temp hack to set reistor names */
 extern utSym geRES250Sym, geRES6KSym;
@@ -39,9 +39,11 @@ void htHashBox(utBox box);
 #define htHashInt32(value) htHashUint32(value)
 #define htHashSym(sym) htHashUint32(utSym2Index(sym))
 htEntry htHtblLookupEntry(htHtbl htbl, bool (*matchEntry)(htEntry entry));
+htEntry htHtblLookupNextEntry(htEntry entry, bool (*matchEntry)(htEntry entry));
 uint32 htHtblLookup(htHtbl htbl, bool (*matchEntry)(htEntry entry));
 htEntry htHtblAdd(htHtbl htbl, uint32 data);
 void htHtblRemoveEntry(htHtbl htbl, htEntry entry);
+void htHtblClear(htHtbl htbl);
 
 /* Symbol table support */
 void htHtblAddSym(htHtbl htbl, utSym sym);
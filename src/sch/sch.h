@@ -38,6 +38,14 @@ void schGensymStart(void);
 void schGensymStop(void);
 void schStart(void);
 void schStop(void);
+void schStartLoader(char *fileName);
+void schStopLoader(void);
+char *schOpenFile(char *fileName, size_t *lengthPtr);
+void schCloseFile(char *text);
+void schStartSymbolCache(void);
+void schStopSymbolCache(void);
+schSymbol schReadCachedSymbol(char *fileName);
+void schCacheSymbol(char *fileName, schSymbol symbol);
 
 /* Constructors */
 schAttr schAttrCreate(int32 x, int32 y, utSym name, utSym value,
@@ -0,0 +1,545 @@
+/*
+ * Copyright (C) 2003 ViASIC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program; if not, write to the Free Software 
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111 USA
+ */
+
+/*--------------------------------------------------------------------------------------------------
+  Cache parsed symbols in a file between runs.  The cache holds what readSymbol builds: the
+  symbol's attributes, and its mpins with their attributes.  Post-processing still happens as
+  usual after a symbol is loaded from the cache.  Each entry is keyed by the symbol file's full
+  path, and is used if the file's size and modification time match.  If only the time changed,
+  the entry is still used if the file's contents hash to the same value.
+--------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "sch.h"
+
+#define SCH_CACHE_MAGIC "GNETSYMC"
+#define SCH_CACHE_MAGIC_LENGTH 8
+#define SCH_CACHE_VERSION 1
+#define SCH_CACHE_ENDIAN_CHECK 0x01020304
+#define SCH_NULL_STRING UINT32_MAX
+
+static uint8 *schCacheData, *schAddedData; /* schAddedData is NULL until the cache is started */
+static uint32 schCacheDataLength, schAddedDataLength, schAddedDataSize;
+static uint8 *schReadPos, *schReadEnd;
+static bool schCacheEnabled, schCacheCorrupt, schCacheChanged;
+
+/*--------------------------------------------------------------------------------------------------
+  Copy bytes out of the cache data.  If we run off the end, zero fill and flag the data as
+  corrupt.
+--------------------------------------------------------------------------------------------------*/
+static void readBytes(
+    void *data,
+    uint32 length)
+{
+    if(length > (uint32)(schReadEnd - schReadPos)) {
+        memset(data, 0, length);
+        schCacheCorrupt = true;
+        return;
+    }
+    memcpy(data, schReadPos, length);
+    schReadPos += length;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read a uint32 from the cache data.
+--------------------------------------------------------------------------------------------------*/
+static uint32 readUint32(void)
+{
+    uint32 value;
+
+    readBytes(&value, sizeof(uint32));
+    return value;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read an int32 from the cache data.
+--------------------------------------------------------------------------------------------------*/
+static int32 readInt32(void)
+{
+    int32 value;
+
+    readBytes(&value, sizeof(int32));
+    return value;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read a uint8 from the cache data.
+--------------------------------------------------------------------------------------------------*/
+static uint8 readUint8(void)
+{
+    uint8 value;
+
+    readBytes(&value, sizeof(uint8));
+    return value;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read a uint64 from the cache data.
+--------------------------------------------------------------------------------------------------*/
+static uint64 readUint64(void)
+{
+    uint64 value;
+
+    readBytes(&value, sizeof(uint64));
+    return value;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read a symbol name from the cache data.
+--------------------------------------------------------------------------------------------------*/
+static utSym readSym(void)
+{
+    uint32 length = readUint32();
+    utSym sym;
+    char *name;
+
+    if(length == SCH_NULL_STRING) {
+        return utSymNull;
+    }
+    if(length > (uint32)(schReadEnd - schReadPos)) {
+        schCacheCorrupt = true;
+        return utSymNull;
+    }
+    name = utNewA(char, length + 1);
+    readBytes(name, length);
+    name[length] = '\0';
+    sym = utSymCreate(name);
+    utFree(name);
+    return sym;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add bytes to the new cache data.
+--------------------------------------------------------------------------------------------------*/
+static void writeBytes(
+    void *data,
+    uint32 length)
+{
+    if(schAddedDataLength + length > schAddedDataSize) {
+        schAddedDataSize = (schAddedDataLength + length) << 1;
+        utResizeArray(schAddedData, schAddedDataSize);
+    }
+    memcpy(schAddedData + schAddedDataLength, data, length);
+    schAddedDataLength += length;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a uint32 to the new cache data.
+--------------------------------------------------------------------------------------------------*/
+static void writeUint32(
+    uint32 value)
+{
+    writeBytes(&value, sizeof(uint32));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add an int32 to the new cache data.
+--------------------------------------------------------------------------------------------------*/
+static void writeInt32(
+    int32 value)
+{
+    writeBytes(&value, sizeof(int32));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a uint8 to the new cache data.
+--------------------------------------------------------------------------------------------------*/
+static void writeUint8(
+    uint8 value)
+{
+    writeBytes(&value, sizeof(uint8));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a symbol name to the new cache data.
+--------------------------------------------------------------------------------------------------*/
+static void writeSym(
+    utSym sym)
+{
+    uint32 length;
+
+    if(sym == utSymNull) {
+        writeUint32(SCH_NULL_STRING);
+        return;
+    }
+    length = strlen(utSymGetName(sym));
+    writeUint32(length);
+    writeBytes(utSymGetName(sym), length);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Hash the contents of the file.  Return false if it can't be read.
+--------------------------------------------------------------------------------------------------*/
+static bool hashFile(
+    char *fileName,
+    uint32 *hash)
+{
+    FILE *file = fopen(fileName, "rb");
+    uint8 buffer[1 << 14];
+    size_t length, xByte;
+    uint32 value = 2166136261U;
+
+    if(file == NULL) {
+        return false;
+    }
+    while((length = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for(xByte = 0; xByte < length; xByte++) {
+            value = (value ^ buffer[xByte])*16777619U;
+        }
+    }
+    fclose(file);
+    *hash = value;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read the cache file into memory, and build a Cached object for each entry.
+--------------------------------------------------------------------------------------------------*/
+static bool readCacheFile(
+    char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    struct stat fileStat;
+    schCached cached;
+    char magic[SCH_CACHE_MAGIC_LENGTH];
+    utSym path;
+
+    if(file == NULL) {
+        return false;
+    }
+    if(fstat(fileno(file), &fileStat) || fileStat.st_size == 0) {
+        fclose(file);
+        return false;
+    }
+    schCacheDataLength = fileStat.st_size;
+    schCacheData = utNewA(uint8, schCacheDataLength);
+    if(fread(schCacheData, 1, schCacheDataLength, file) != schCacheDataLength) {
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+    schReadPos = schCacheData;
+    schReadEnd = schCacheData + schCacheDataLength;
+    schCacheCorrupt = false;
+    readBytes(magic, SCH_CACHE_MAGIC_LENGTH);
+    if(strncmp(magic, SCH_CACHE_MAGIC, SCH_CACHE_MAGIC_LENGTH) ||
+            readUint32() != SCH_CACHE_VERSION || readUint32() != SCH_CACHE_ENDIAN_CHECK) {
+        return false;
+    }
+    while(schReadPos < schReadEnd && !schCacheCorrupt) {
+        path = readSym();
+        cached = schCachedAlloc();
+        schCachedSetMtime(cached, readUint64());
+        schCachedSetSize(cached, readUint64());
+        schCachedSetHash(cached, readUint32());
+        schCachedSetLength(cached, readUint32());
+        schCachedSetOffset(cached, schReadPos - schCacheData);
+        if(schCachedGetLength(cached) > (uint32)(schReadEnd - schReadPos) || path == utSymNull ||
+                schRootFindCached(schTheRoot, path) != schCachedNull) {
+            schCacheCorrupt = true;
+            schCachedDestroy(cached);
+        } else {
+            schReadPos += schCachedGetLength(cached);
+            schCachedSetSym(cached, path);
+            schRootInsertCached(schTheRoot, cached);
+        }
+    }
+    return !schCacheCorrupt;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Load the symbol cache, if one is set.
+--------------------------------------------------------------------------------------------------*/
+void schStartSymbolCache(void)
+{
+    schCached cached;
+    char *fileName = dbSymbolCacheFile;
+    struct stat fileStat;
+
+    schCacheEnabled = *fileName != '\0';
+    schCacheChanged = false;
+    schCacheData = NULL;
+    schCacheDataLength = 0;
+    schAddedDataSize = 1024;
+    schAddedDataLength = 0;
+    schAddedData = utNewA(uint8, schAddedDataSize);
+    if(!schCacheEnabled || stat(fileName, &fileStat)) {
+        return;
+    }
+    if(!readCacheFile(fileName)) {
+        utWarning("Symbol cache %s is corrupt or out of date, rebuilding it", fileName);
+        schSafeForeachRootCached(schTheRoot, cached) {
+            schCachedDestroy(cached);
+        } schEndSafeRootCached;
+        schCacheChanged = true;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write the symbol cache file.
+--------------------------------------------------------------------------------------------------*/
+static void writeCacheFile(
+    char *fileName)
+{
+    FILE *file = fopen(fileName, "wb");
+    schCached cached;
+    uint32 version = SCH_CACHE_VERSION;
+    uint32 endianCheck = SCH_CACHE_ENDIAN_CHECK;
+    uint64 value64;
+    uint32 value32;
+    uint8 *data;
+
+    if(file == NULL) {
+        utWarning("Unable to write symbol cache %s", fileName);
+        return;
+    }
+    fwrite(SCH_CACHE_MAGIC, 1, SCH_CACHE_MAGIC_LENGTH, file);
+    fwrite(&version, sizeof(uint32), 1, file);
+    fwrite(&endianCheck, sizeof(uint32), 1, file);
+    schForeachRootCached(schTheRoot, cached) {
+        value32 = strlen(schCachedGetName(cached));
+        fwrite(&value32, sizeof(uint32), 1, file);
+        fwrite(schCachedGetName(cached), 1, value32, file);
+        value64 = schCachedGetMtime(cached);
+        fwrite(&value64, sizeof(uint64), 1, file);
+        value64 = schCachedGetSize(cached);
+        fwrite(&value64, sizeof(uint64), 1, file);
+        value32 = schCachedGetHash(cached);
+        fwrite(&value32, sizeof(uint32), 1, file);
+        value32 = schCachedGetLength(cached);
+        fwrite(&value32, sizeof(uint32), 1, file);
+        data = schCachedAdded(cached)? schAddedData : schCacheData;
+        fwrite(data + schCachedGetOffset(cached), 1, value32, file);
+    } schEndRootCached;
+    fclose(file);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write the symbol cache if it changed, and free its memory.
+--------------------------------------------------------------------------------------------------*/
+void schStopSymbolCache(void)
+{
+    schCached cached;
+
+    if(schCacheEnabled && schCacheChanged) {
+        writeCacheFile(dbSymbolCacheFile);
+    }
+    schSafeForeachRootCached(schTheRoot, cached) {
+        schCachedDestroy(cached);
+    } schEndSafeRootCached;
+    if(schCacheData != NULL) {
+        utFree(schCacheData);
+        schCacheData = NULL;
+    }
+    utFree(schAddedData);
+    schAddedData = NULL;
+    schCacheEnabled = false;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read a list of attributes from the cache data.
+--------------------------------------------------------------------------------------------------*/
+static schAttr readAttrs(void)
+{
+    schAttr attr, firstAttr = schAttrNull, lastAttr = schAttrNull;
+    uint32 numAttrs = readUint32();
+    int32 x, y;
+    utSym name, value;
+    uint8 flags, color, size, angle, alignment;
+
+    while(numAttrs-- != 0 && !schCacheCorrupt) {
+        x = readInt32();
+        y = readInt32();
+        name = readSym();
+        value = readSym();
+        flags = readUint8();
+        color = readUint8();
+        size = readUint8();
+        angle = readUint8();
+        alignment = readUint8();
+        attr = schAttrCreate(x, y, name, value, (flags & 4) != 0, (flags & 2) != 0,
+            (flags & 1) != 0, color, size, angle, alignment);
+        if(firstAttr == schAttrNull) {
+            firstAttr = attr;
+        } else {
+            schAttrSetNextAttr(lastAttr, attr);
+        }
+        lastAttr = attr;
+    }
+    return firstAttr;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a list of attributes to the new cache data.
+--------------------------------------------------------------------------------------------------*/
+static void writeAttrs(
+    schAttr firstAttr)
+{
+    schAttr attr;
+    uint32 numAttrs = 0;
+
+    for(attr = firstAttr; attr != schAttrNull; attr = schAttrGetNextAttr(attr)) {
+        numAttrs++;
+    }
+    writeUint32(numAttrs);
+    for(attr = firstAttr; attr != schAttrNull; attr = schAttrGetNextAttr(attr)) {
+        writeInt32(schAttrGetX(attr));
+        writeInt32(schAttrGetY(attr));
+        writeSym(schAttrGetName(attr));
+        writeSym(schAttrGetValue(attr));
+        writeUint8((schAttrVisible(attr)? 4 : 0) | (schAttrShowName(attr)? 2 : 0) |
+            (schAttrShowValue(attr)? 1 : 0));
+        writeUint8(schAttrGetColor(attr));
+        writeUint8(schAttrGetSize(attr));
+        writeUint8(schAttrGetAngle(attr));
+        writeUint8(schAttrGetAlignment(attr));
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the cache entry for the file, if it is still valid.
+--------------------------------------------------------------------------------------------------*/
+static schCached findValidCached(
+    char *fileName)
+{
+    schCached cached = schRootFindCached(schTheRoot, utSymCreate(fileName));
+    struct stat fileStat;
+    uint32 hash;
+
+    if(cached == schCachedNull || stat(fileName, &fileStat)) {
+        return schCachedNull;
+    }
+    if((uint64)fileStat.st_size != schCachedGetSize(cached)) {
+        return schCachedNull;
+    }
+    if((uint64)fileStat.st_mtime != schCachedGetMtime(cached)) {
+        /* It may just have been touched */
+        if(!hashFile(fileName, &hash) || hash != schCachedGetHash(cached)) {
+            return schCachedNull;
+        }
+        schCachedSetMtime(cached, fileStat.st_mtime);
+        schCacheChanged = true;
+    }
+    return cached;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the symbol from the cache, if the cache is started and the file has a valid entry.  The
+  caller still has to post-process it.
+--------------------------------------------------------------------------------------------------*/
+schSymbol schReadCachedSymbol(
+    char *fileName)
+{
+    schCached cached;
+    schSymbol symbol;
+    schMpin mpin;
+    utSym name, path;
+    uint32 numMpins, type, sequence, left, right;
+    int32 x, y;
+    bool isBus;
+    uint8 *data;
+
+    if(schAddedData == NULL || !schCacheEnabled) {
+        return schSymbolNull;
+    }
+    cached = findValidCached(fileName);
+    if(cached == schCachedNull) {
+        return schSymbolNull;
+    }
+    data = schCachedAdded(cached)? schAddedData : schCacheData;
+    schReadPos = data + schCachedGetOffset(cached);
+    schReadEnd = schReadPos + schCachedGetLength(cached);
+    schCacheCorrupt = false;
+    path = utSymCreate(utDirName(fileName));
+    symbol = schSymbolCreate(utSymCreate(utBaseName(fileName)), DB_SUBCIRCUIT, path);
+    schSymbolSetAttr(symbol, readAttrs());
+    numMpins = readUint32();
+    while(numMpins-- != 0 && !schCacheCorrupt) {
+        name = readSym();
+        type = readUint32();
+        sequence = readUint32();
+        x = readInt32();
+        y = readInt32();
+        isBus = readUint8() != 0;
+        left = readUint32();
+        right = readUint32();
+        mpin = schMpinCreate(symbol, name, schCompNull, (dbMportType)type, sequence, x, y,
+            isBus, left, right);
+        schMpinSetAttr(mpin, readAttrs());
+    }
+    if(schCacheCorrupt) {
+        utWarning("Symbol cache entry for %s is corrupt, reading the file", fileName);
+        schSymbolDestroy(symbol);
+        schCachedDestroy(cached);
+        schCacheChanged = true;
+        return schSymbolNull;
+    }
+    schSymbolSetDevice(symbol, schFindAttrValue(schSymbolGetAttr(symbol), schDeviceSym));
+    return symbol;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add the newly read symbol to the cache, replacing any stale entry for the file.  Symbols read
+  when the cache is not started, such as by schGenerateSymbolFile, are not cached.
+--------------------------------------------------------------------------------------------------*/
+void schCacheSymbol(
+    char *fileName,
+    schSymbol symbol)
+{
+    utSym path = utSymCreate(fileName);
+    schCached cached;
+    schMpin mpin;
+    struct stat fileStat;
+    uint32 hash, numMpins = 0;
+
+    if(schAddedData == NULL || !schCacheEnabled || stat(fileName, &fileStat) ||
+            !hashFile(fileName, &hash)) {
+        return;
+    }
+    cached = schRootFindCached(schTheRoot, path);
+    if(cached != schCachedNull) {
+        schCachedDestroy(cached);
+    }
+    cached = schCachedAlloc();
+    schCachedSetSym(cached, path);
+    schCachedSetMtime(cached, fileStat.st_mtime);
+    schCachedSetSize(cached, fileStat.st_size);
+    schCachedSetHash(cached, hash);
+    schCachedSetAdded(cached, true);
+    schCachedSetOffset(cached, schAddedDataLength);
+    writeAttrs(schSymbolGetAttr(symbol));
+    schForeachSymbolMpin(symbol, mpin) {
+        numMpins++;
+    } schEndSymbolMpin;
+    writeUint32(numMpins);
+    schForeachSymbolMpin(symbol, mpin) {
+        writeSym(schMpinGetSym(mpin));
+        writeUint32(schMpinGetType(mpin));
+        writeUint32(schMpinGetSequence(mpin));
+        writeInt32(schMpinGetX(mpin));
+        writeInt32(schMpinGetY(mpin));
+        writeUint8(schMpinBus(mpin));
+        writeUint32(schMpinGetLeft(mpin));
+        writeUint32(schMpinGetRight(mpin));
+        writeAttrs(schMpinGetAttr(mpin));
+    } schEndSymbolMpin;
+    schCachedSetLength(cached, schAddedDataLength - schCachedGetOffset(cached));
+    schRootInsertCached(schTheRoot, cached);
+    schCacheChanged = true;
+}
@@ -0,0 +1,533 @@
+/*
+ * Copyright (C) 2003 ViASIC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program; if not, write to the Free Software 
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111 USA
+ */
+
+/*--------------------------------------------------------------------------------------------------
+  Load schematic and symbol files in parallel.  Loader threads read each file into memory, scan it
+  for the symbols and schematics it refers to, and queue those to be read too.  The main thread
+  still reads the hierarchy in the usual order, and builds all the sch objects, but it gets file
+  text from memory instead of waiting on the file system for each file in turn.
+
+  The utility and DataDraw routines are not thread safe, so the loader threads only use the
+  records in this file, and plain malloc.
+
+  Files are handed to the reader as writable text terminated with '\0', so it can cut lines out
+  of it in place.  Files the loader doesn't have are mapped into memory when possible.
+--------------------------------------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include "sch.h"
+
+/*--------------------------------------------------------------------------------------------------
+  Read the whole file into memory allocated with malloc.  The text is terminated with '\0', so it
+  can be scanned with sscanf.  Return NULL if the file can't be opened.
+--------------------------------------------------------------------------------------------------*/
+static char *readFile(
+    char *fileName,
+    size_t *lengthPtr)
+{
+    FILE *stream = fopen(fileName, "rb");
+    size_t size = 1 << 16;
+    size_t length = 0;
+    char *text;
+
+    if(stream == NULL) {
+        return NULL;
+    }
+    text = malloc(size);
+    while(!feof(stream) && !ferror(stream)) {
+        if(length + 1 == size) {
+            size <<= 1;
+            text = realloc(text, size);
+        }
+        length += fread(text + length, 1, size - length - 1, stream);
+    }
+    fclose(stream);
+    text[length] = '\0';
+    *lengthPtr = length;
+    return text;
+}
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SCH_LOAD_HASH_SIZE 4096
+#define SCH_MAX_NAME_LENGTH 1024
+
+/* A file read by the loader */
+typedef struct schLoadFileStruct *schLoadFile;
+struct schLoadFileStruct {
+    char *fileName;
+    bool isSymbol;
+    bool claimed; /* A thread has started reading it */
+    bool loaded;
+    char *text; /* NULL if the file could not be read */
+    size_t length;
+    schLoadFile nextHashFile;
+    schLoadFile nextQueuedFile;
+};
+
+static pthread_mutex_t schLoadMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t schLoadCond = PTHREAD_COND_INITIALIZER;
+static pthread_t *schLoadThreads;
+static uint32 schNumLoadThreads;
+static bool schLoaderRunning, schLoaderStopping;
+static schLoadFile schLoadHash[SCH_LOAD_HASH_SIZE];
+static schLoadFile schFirstQueuedFile, schLastQueuedFile;
+static schLoadFile schOpenedFile;
+static size_t schOpenedLength;
+static bool schOpenedMapped;
+static char *schLoadComponentPath, *schLoadSourcePath, *schLoadCwd;
+
+/*--------------------------------------------------------------------------------------------------
+  Copy a string with malloc.
+--------------------------------------------------------------------------------------------------*/
+static char *copyString(
+    char *string)
+{
+    char *copy = malloc(strlen(string) + 1);
+
+    strcpy(copy, string);
+    return copy;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build an absolute path without "." or empty directories, so that the loader threads and the main
+  thread find the same record for a file.  The result is allocated with malloc.
+--------------------------------------------------------------------------------------------------*/
+static char *normalizePath(
+    char *fileName)
+{
+    char *path = malloc(strlen(schLoadCwd) + strlen(fileName) + 2);
+    char *p, *q;
+
+    if(*fileName == '/') {
+        strcpy(path, fileName);
+    } else {
+        sprintf(path, "%s/%s", schLoadCwd, fileName);
+    }
+    p = path;
+    q = path;
+    while(*p != '\0') {
+        if(*p == '/' && (p[1] == '/' || (p[1] == '.' && (p[2] == '/' || p[2] == '\0')))) {
+            p += p[1] == '/'? 1 : 2;
+        } else {
+            *q++ = *p++;
+        }
+    }
+    *q = '\0';
+    return path;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Hash a file name.
+--------------------------------------------------------------------------------------------------*/
+static uint32 hashFileName(
+    char *fileName)
+{
+    uint32 hash = 5381;
+
+    while(*fileName != '\0') {
+        hash = (hash << 5) + hash + (uint8)*fileName++;
+    }
+    return hash & (SCH_LOAD_HASH_SIZE - 1);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the record for the normalized file name.  The caller must hold schLoadMutex.
+--------------------------------------------------------------------------------------------------*/
+static schLoadFile findLoadFile(
+    char *fileName)
+{
+    schLoadFile file;
+
+    for(file = schLoadHash[hashFileName(fileName)]; file != NULL; file = file->nextHashFile) {
+        if(!strcmp(file->fileName, fileName)) {
+            return file;
+        }
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Queue the file to be read, unless we've seen it already.  This takes ownership of the
+  normalized file name.  The caller must hold schLoadMutex.
+--------------------------------------------------------------------------------------------------*/
+static void queueFile(
+    char *fileName,
+    bool isSymbol)
+{
+    schLoadFile file = findLoadFile(fileName);
+    uint32 hash;
+
+    if(file != NULL) {
+        free(fileName);
+        return;
+    }
+    file = calloc(1, sizeof(struct schLoadFileStruct));
+    file->fileName = fileName;
+    file->isSymbol = isSymbol;
+    hash = hashFileName(fileName);
+    file->nextHashFile = schLoadHash[hash];
+    schLoadHash[hash] = file;
+    if(schLastQueuedFile == NULL) {
+        schFirstQueuedFile = file;
+    } else {
+        schLastQueuedFile->nextQueuedFile = file;
+    }
+    schLastQueuedFile = file;
+    pthread_cond_broadcast(&schLoadCond);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the file the way schpost.c does: first in the directory of the file referring to it, then
+  in the search path.  The result is allocated with malloc, or NULL if it isn't found.
+--------------------------------------------------------------------------------------------------*/
+static char *findFile(
+    char *dirName,
+    char *name,
+    char *searchPath)
+{
+    char *path = malloc(strlen(dirName) + strlen(searchPath) + strlen(name) + 2);
+    char *start = searchPath;
+    char *end;
+    size_t length;
+
+    sprintf(path, "%s/%s", dirName, name);
+    if(!access(path, R_OK)) {
+        return path;
+    }
+    while(*start != '\0') {
+        end = strchr(start, ':');
+        length = end == NULL? strlen(start) : (size_t)(end - start);
+        memcpy(path, start, length);
+        sprintf(path + length, "/%s", name);
+        if(length > 0 && !access(path, R_OK)) {
+            return path;
+        }
+        start += length;
+        if(*start == ':') {
+            start++;
+        }
+    }
+    free(path);
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find and queue a file referred to from the file.
+--------------------------------------------------------------------------------------------------*/
+static void queueReferencedFile(
+    schLoadFile file,
+    char *name,
+    bool isSymbol)
+{
+    char *dirName = copyString(file->fileName);
+    char *fileName;
+
+    *strrchr(dirName, '/') = '\0';
+    fileName = findFile(dirName, name, isSymbol? schLoadComponentPath : schLoadSourcePath);
+    free(dirName);
+    if(fileName == NULL) {
+        return; /* The main thread will report it */
+    }
+    pthread_mutex_lock(&schLoadMutex);
+    queueFile(normalizePath(fileName), isSymbol);
+    pthread_mutex_unlock(&schLoadMutex);
+    free(fileName);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Scan the file text for components in schematics, and source attributes in symbols, and queue
+  the files they refer to.
+--------------------------------------------------------------------------------------------------*/
+static void queueReferencedFiles(
+    schLoadFile file)
+{
+    char name[SCH_MAX_NAME_LENGTH];
+    char *line = file->text;
+    char *end = file->text + file->length;
+
+    while(line < end) {
+        if(!file->isSymbol && *line == OBJ_COMPLEX) {
+            if(sscanf(line, "%*c %*d %*d %*d %*d %*d %1023s", name) == 1) {
+                queueReferencedFile(file, name, true);
+            }
+        } else if(file->isSymbol && !strncmp(line, "source=", 7)) {
+            if(sscanf(line + 7, "%1023s", name) == 1) {
+                queueReferencedFile(file, name, false);
+            }
+        }
+        line = memchr(line, '\n', end - line);
+        if(line == NULL) {
+            return;
+        }
+        line++;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read the whole file into memory, then queue the files it refers to.
+--------------------------------------------------------------------------------------------------*/
+static void loadFile(
+    schLoadFile file)
+{
+    file->text = readFile(file->fileName, &file->length);
+    if(file->text != NULL) {
+        queueReferencedFiles(file);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Loader thread: read queued files until we're stopped.
+--------------------------------------------------------------------------------------------------*/
+static void *loadThread(
+    void *arg)
+{
+    schLoadFile file;
+
+    pthread_mutex_lock(&schLoadMutex);
+    while(!schLoaderStopping) {
+        file = schFirstQueuedFile;
+        if(file == NULL) {
+            pthread_cond_wait(&schLoadCond, &schLoadMutex);
+        } else {
+            schFirstQueuedFile = file->nextQueuedFile;
+            if(schFirstQueuedFile == NULL) {
+                schLastQueuedFile = NULL;
+            }
+            if(!file->claimed) {
+                file->claimed = true;
+                pthread_mutex_unlock(&schLoadMutex);
+                loadFile(file);
+                pthread_mutex_lock(&schLoadMutex);
+                file->loaded = true;
+                pthread_cond_broadcast(&schLoadCond);
+            }
+        }
+    }
+    pthread_mutex_unlock(&schLoadMutex);
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Start the loader threads, and queue the top level schematic.  If only one thread is allowed, we
+  don't start any, and files are read directly as before.
+--------------------------------------------------------------------------------------------------*/
+void schStartLoader(
+    char *fileName)
+{
+    uint32 xThread;
+    char cwd[SCH_MAX_NAME_LENGTH << 2];
+
+    if(dbNumThreads <= 1 || getcwd(cwd, sizeof(cwd)) == NULL) {
+        return;
+    }
+    schLoadCwd = copyString(cwd);
+    schLoadComponentPath = copyString(dbGschemComponentPath);
+    schLoadSourcePath = copyString(dbGschemSourcePath);
+    schLoaderStopping = false;
+    schLoaderRunning = true;
+    queueFile(normalizePath(fileName), false);
+    schNumLoadThreads = dbNumThreads;
+    schLoadThreads = utNewA(pthread_t, schNumLoadThreads);
+    for(xThread = 0; xThread < schNumLoadThreads; xThread++) {
+        pthread_create(schLoadThreads + xThread, NULL, loadThread, NULL);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Stop the loader threads, and free the file records.
+--------------------------------------------------------------------------------------------------*/
+void schStopLoader(void)
+{
+    schLoadFile file, nextFile;
+    uint32 xThread, xHash;
+
+    if(!schLoaderRunning) {
+        return;
+    }
+    pthread_mutex_lock(&schLoadMutex);
+    schLoaderStopping = true;
+    pthread_cond_broadcast(&schLoadCond);
+    pthread_mutex_unlock(&schLoadMutex);
+    for(xThread = 0; xThread < schNumLoadThreads; xThread++) {
+        pthread_join(schLoadThreads[xThread], NULL);
+    }
+    utFree(schLoadThreads);
+    for(xHash = 0; xHash < SCH_LOAD_HASH_SIZE; xHash++) {
+        for(file = schLoadHash[xHash]; file != NULL; file = nextFile) {
+            nextFile = file->nextHashFile;
+            free(file->fileName);
+            free(file->text);
+            free(file);
+        }
+        schLoadHash[xHash] = NULL;
+    }
+    schFirstQueuedFile = NULL;
+    schLastQueuedFile = NULL;
+    free(schLoadCwd);
+    free(schLoadComponentPath);
+    free(schLoadSourcePath);
+    schLoaderRunning = false;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Map the file into memory, privately, so the reader can write to its copy.  Only files ending in
+  a newline are mapped, so that the reader can terminate the last line without writing past the
+  end of the mapping.  Return NULL if the file can't be mapped.
+--------------------------------------------------------------------------------------------------*/
+static char *mapFile(
+    char *fileName,
+    size_t *lengthPtr)
+{
+    int fd = open(fileName, O_RDONLY);
+    struct stat fileStat;
+    char *text;
+
+    if(fd < 0) {
+        return NULL;
+    }
+    if(fstat(fd, &fileStat) || fileStat.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    text = mmap(NULL, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(text == MAP_FAILED) {
+        return NULL;
+    }
+    if(text[fileStat.st_size - 1] != '\n') {
+        munmap(text, fileStat.st_size);
+        return NULL;
+    }
+    *lengthPtr = fileStat.st_size;
+    return text;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the loader's record of the file, and wait for it to be read.  If no loader thread has
+  started on it, read it here.
+--------------------------------------------------------------------------------------------------*/
+static schLoadFile findLoadedFile(
+    char *fileName)
+{
+    schLoadFile file;
+    char *path = normalizePath(fileName);
+
+    pthread_mutex_lock(&schLoadMutex);
+    file = findLoadFile(path);
+    free(path);
+    if(file != NULL && !file->claimed) {
+        file->claimed = true;
+        pthread_mutex_unlock(&schLoadMutex);
+        loadFile(file);
+        pthread_mutex_lock(&schLoadMutex);
+        file->loaded = true;
+    }
+    while(file != NULL && !file->loaded) {
+        pthread_cond_wait(&schLoadCond, &schLoadMutex);
+    }
+    pthread_mutex_unlock(&schLoadMutex);
+    return file;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Open a schematic or symbol file for reading, and return its text, terminated with '\0'.  The
+  text may be modified by the caller.  If the loader has the file, return the loader's copy.
+  Otherwise map the file, or failing that, read it.  Return NULL if the file can't be read.  Only
+  one file is open at a time.
+--------------------------------------------------------------------------------------------------*/
+char *schOpenFile(
+    char *fileName,
+    size_t *lengthPtr)
+{
+    schLoadFile file = NULL;
+    char *text;
+
+    if(schLoaderRunning) {
+        file = findLoadedFile(fileName);
+    }
+    schOpenedMapped = false;
+    if(file != NULL && file->text != NULL) {
+        schOpenedFile = file;
+        *lengthPtr = file->length;
+        return file->text;
+    }
+    schOpenedFile = NULL;
+    text = mapFile(fileName, lengthPtr);
+    if(text != NULL) {
+        schOpenedMapped = true;
+        schOpenedLength = *lengthPtr;
+        return text;
+    }
+    return readFile(fileName, lengthPtr);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Close a file opened with schOpenFile, and free its text, since each file is only read once.
+--------------------------------------------------------------------------------------------------*/
+void schCloseFile(
+    char *text)
+{
+    if(schOpenedMapped) {
+        munmap(text, schOpenedLength);
+    } else if(schOpenedFile != NULL) {
+        pthread_mutex_lock(&schLoadMutex);
+        free(schOpenedFile->text);
+        schOpenedFile->text = NULL;
+        schOpenedFile->length = 0;
+        pthread_mutex_unlock(&schLoadMutex);
+    } else {
+        free(text);
+    }
+    schOpenedFile = NULL;
+    schOpenedMapped = false;
+}
+
+#else
+
+/*--------------------------------------------------------------------------------------------------
+  Without pthreads, files are just read directly.
+--------------------------------------------------------------------------------------------------*/
+void schStartLoader(
+    char *fileName)
+{
+}
+
+void schStopLoader(void)
+{
+}
+
+char *schOpenFile(
+    char *fileName,
+    size_t *lengthPtr)
+{
+    return readFile(fileName, lengthPtr);
+}
+
+void schCloseFile(
+    char *text)
+{
+    free(text);
+}
+
+#endif
@@ -88,7 +88,11 @@ dbDesign schReadSchematic(
 
     utLogMessage("Reading schematic file %s", fileName);
     schStart();
+    schStartLoader(fileName);
+    schStartSymbolCache();
     schem = schReadSchem(fileName, true);
+    schStopSymbolCache();
+    schStopLoader();
     if(schem == schSchemNull) {
         return dbDesignNull;
     }
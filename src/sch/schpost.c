@@ -20,15 +20,25 @@
   Routines manipulating schematics.
 --------------------------------------------------------------------------------------------------*/
 #include <ctype.h>
+#include <stdlib.h>
 #include <string.h>
 #include "sch.h"
+#include "htext.h"
+
+/* Geometric index of the wires in the schematic being post-processed */
+static schWireArray schHorWires, schVertWires;
+static uint32 schMaxHorWidth, schMaxVertHeight;
+static htHtbl schEndPointTable;
+static int32 schPointX, schPointY;
 
 /*--------------------------------------------------------------------------------------------------
   Allocate memory used in the schematic manipulation module.
 --------------------------------------------------------------------------------------------------*/
 void schStartSchem(void)
 {
-    /* Nothing for now */
+    schHorWires = schWireArrayAlloc();
+    schVertWires = schWireArrayAlloc();
+    schEndPointTable = htHtblCreate();
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -36,7 +46,10 @@ void schStartSchem(void)
 --------------------------------------------------------------------------------------------------*/
 void schStopSchem(void)
 {
-    /* Nothing for now */
+    htHtblClear(schEndPointTable);
+    htHtblDestroy(schEndPointTable);
+    schWireArrayFree(schVertWires);
+    schWireArrayFree(schHorWires);
 }
 
 
@@ -203,42 +216,244 @@ schConn schFindConnFromWires(
 }
 
 /*--------------------------------------------------------------------------------------------------
-  Find the other wire at the point on the wire.  Only find wires with no connections to this wire.
+  Find the coordinate that is constant along a horizontal or vertical wire.
+--------------------------------------------------------------------------------------------------*/
+static int32 findWireTrack(
+    schWire wire,
+    bool vertical)
+{
+    return vertical? schWireGetX1(wire) : schWireGetY1(wire);
+}
 
-  Note: speed this up with sorted vertical and horizontal arrays, and end-point hash tables.
+/*--------------------------------------------------------------------------------------------------
+  Find the low end of a horizontal or vertical wire along its track.
 --------------------------------------------------------------------------------------------------*/
-static schWire findOtherWireAtPoint(
-    schSchem schem,
+static int32 findWireLow(
+    schWire wire,
+    bool vertical)
+{
+    if(vertical) {
+        return utMin(schWireGetY1(wire), schWireGetY2(wire));
+    }
+    return utMin(schWireGetX1(wire), schWireGetX2(wire));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the high end of a horizontal or vertical wire along its track.
+--------------------------------------------------------------------------------------------------*/
+static int32 findWireHigh(
+    schWire wire,
+    bool vertical)
+{
+    if(vertical) {
+        return utMax(schWireGetY1(wire), schWireGetY2(wire));
+    }
+    return utMax(schWireGetX1(wire), schWireGetX2(wire));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Compare two wires by track, then low end, then sequence.
+--------------------------------------------------------------------------------------------------*/
+static int compareWires(
+    schWire wire1,
+    schWire wire2,
+    bool vertical)
+{
+    int32 value1 = findWireTrack(wire1, vertical);
+    int32 value2 = findWireTrack(wire2, vertical);
+
+    if(value1 != value2) {
+        return value1 < value2? -1 : 1;
+    }
+    value1 = findWireLow(wire1, vertical);
+    value2 = findWireLow(wire2, vertical);
+    if(value1 != value2) {
+        return value1 < value2? -1 : 1;
+    }
+    if(schWireGetSequence(wire1) != schWireGetSequence(wire2)) {
+        return schWireGetSequence(wire1) < schWireGetSequence(wire2)? -1 : 1;
+    }
+    return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Compare two horizontal wires for qsort.
+--------------------------------------------------------------------------------------------------*/
+static int compareHorWires(
+    const void *wire1Ptr,
+    const void *wire2Ptr)
+{
+    return compareWires(*(schWire *)wire1Ptr, *(schWire *)wire2Ptr, false);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Compare two vertical wires for qsort.
+--------------------------------------------------------------------------------------------------*/
+static int compareVertWires(
+    const void *wire1Ptr,
+    const void *wire2Ptr)
+{
+    return compareWires(*(schWire *)wire1Ptr, *(schWire *)wire2Ptr, true);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add the wire to the end-point hash table at the point.
+--------------------------------------------------------------------------------------------------*/
+static void addWireEndPoint(
     schWire wire,
     int32 x,
     int32 y)
 {
-    schWire otherWire;
+    htStartHashKey();
+    htHashInt32(x);
+    htHashInt32(y);
+    htHtblAdd(schEndPointTable, schWire2Index(wire));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the wire in the entry has an end-point at schPointX, schPointY.
+--------------------------------------------------------------------------------------------------*/
+static bool matchWireEndPoint(
+    htEntry entry)
+{
+    schWire wire = schIndex2Wire(htEntryGetData(entry));
+
+    return (schWireGetX1(wire) == schPointX && schWireGetY1(wire) == schPointY) ||
+        (schWireGetX2(wire) == schPointX && schWireGetY2(wire) == schPointY);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the geometric index of wires in the schematic.  Wires are numbered in the order we
+  traverse them, so lookups can return the same wire a linear search would have found first.
+  End-points of all wires go in a hash table, and horizontal and vertical wires are sorted by
+  track and low end.  Wires can't be added to the schematic while the index is in use.
+--------------------------------------------------------------------------------------------------*/
+static void buildWireIndex(
+    schSchem schem)
+{
+    schWire wire;
     utBox box;
+    uint32 sequence = 0;
 
-    schForeachSchemWire(schem, otherWire) {
-        if(wire == schWireNull || otherWire != wire) {
-            box = schWireFindBox(otherWire);
-            if(utBoxIsHorLine(box) || utBoxIsVertLine(box)) {
-                if(utBoxContainsPoint(box, x, y) && (wire == schWireNull ||
-                        schFindConnFromWires(wire, otherWire) == schConnNull)) {
-                    return otherWire;
-                }
-            } else {
-                if(schWireGetX1(otherWire) == x && schWireGetY1(otherWire) == y &&
-                        (wire == schWireNull ||
-                        schFindConnFromWires(wire, otherWire) == schConnNull)) {
-                    return otherWire;
-                }
-                if(schWireGetX2(otherWire) == x && schWireGetY2(otherWire) == y &&
-                        (wire == schWireNull ||
-                        schFindConnFromWires(wire, otherWire) == schConnNull)) {
-                    return otherWire;
-                }
-            }
+    schWireArraySetUsedWire(schHorWires, 0);
+    schWireArraySetUsedWire(schVertWires, 0);
+    schMaxHorWidth = 0;
+    schMaxVertHeight = 0;
+    htHtblClear(schEndPointTable);
+    schForeachSchemWire(schem, wire) {
+        schWireSetSequence(wire, sequence++);
+        addWireEndPoint(wire, schWireGetX1(wire), schWireGetY1(wire));
+        if(schWireGetX2(wire) != schWireGetX1(wire) || schWireGetY2(wire) != schWireGetY1(wire)) {
+            addWireEndPoint(wire, schWireGetX2(wire), schWireGetY2(wire));
+        }
+        box = schWireFindBox(wire);
+        if(utBoxGetHeight(box) == 0) {
+            schWireArrayAppendWire(schHorWires, wire);
+            schMaxHorWidth = utMax(schMaxHorWidth, utBoxGetWidth(box));
+        }
+        if(utBoxGetWidth(box) == 0) {
+            schWireArrayAppendWire(schVertWires, wire);
+            schMaxVertHeight = utMax(schMaxVertHeight, utBoxGetHeight(box));
         }
     } schEndSchemWire;
-    return schWireNull;
+    qsort(schWireArrayGetWires(schHorWires), schWireArrayGetUsedWire(schHorWires),
+        sizeof(schWire), compareHorWires);
+    qsort(schWireArrayGetWires(schVertWires), schWireArrayGetUsedWire(schVertWires),
+        sizeof(schWire), compareVertWires);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Return the other wire if it can be connected to the wire at a point it touches, and it comes
+  before the best wire found so far.  Otherwise, return the best wire.
+--------------------------------------------------------------------------------------------------*/
+static schWire chooseFirstWire(
+    schWire bestWire,
+    schWire wire,
+    schWire otherWire)
+{
+    if(otherWire == wire) {
+        return bestWire;
+    }
+    if(bestWire != schWireNull && schWireGetSequence(bestWire) <= schWireGetSequence(otherWire)) {
+        return bestWire;
+    }
+    if(wire != schWireNull && schFindConnFromWires(wire, otherWire) != schConnNull) {
+        return bestWire;
+    }
+    return otherWire;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the first horizontal or vertical wire containing the point on the given track.  We binary
+  search for the last wire starting at or before the point, and scan back until no wire could
+  be long enough to reach it.
+--------------------------------------------------------------------------------------------------*/
+static schWire findFirstTrackWireAtPoint(
+    schWireArray wires,
+    uint32 maxLength,
+    bool vertical,
+    int32 track,
+    int32 position,
+    schWire bestWire,
+    schWire wire)
+{
+    schWire otherWire;
+    uint32 low = 0;
+    uint32 high = schWireArrayGetUsedWire(wires);
+    uint32 middle;
+    int32 otherTrack;
+
+    while(low < high) {
+        middle = (low + high) >> 1;
+        otherWire = schWireArrayGetiWire(wires, middle);
+        otherTrack = findWireTrack(otherWire, vertical);
+        if(otherTrack < track || (otherTrack == track &&
+                findWireLow(otherWire, vertical) <= position)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    while(low > 0) {
+        otherWire = schWireArrayGetiWire(wires, --low);
+        if(findWireTrack(otherWire, vertical) != track ||
+                (uint32)(position - findWireLow(otherWire, vertical)) > maxLength) {
+            return bestWire;
+        }
+        if(findWireHigh(otherWire, vertical) >= position) {
+            bestWire = chooseFirstWire(bestWire, wire, otherWire);
+        }
+    }
+    return bestWire;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the other wire at the point on the wire.  Only find wires with no connections to this wire.
+  Horizontal and vertical wires touch the point anywhere along their length, while diagonal wires
+  only touch it at their end-points.  If several wires touch the point, return the first one in
+  the schematic's wire list.  The wire index must already be built.
+--------------------------------------------------------------------------------------------------*/
+static schWire findOtherWireAtPoint(
+    schWire wire,
+    int32 x,
+    int32 y)
+{
+    schWire bestWire = schWireNull;
+    htEntry entry;
+
+    schPointX = x;
+    schPointY = y;
+    htStartHashKey();
+    htHashInt32(x);
+    htHashInt32(y);
+    for(entry = htHtblLookupEntry(schEndPointTable, matchWireEndPoint); entry != htEntryNull;
+            entry = htHtblLookupNextEntry(entry, matchWireEndPoint)) {
+        bestWire = chooseFirstWire(bestWire, wire, schIndex2Wire(htEntryGetData(entry)));
+    }
+    bestWire = findFirstTrackWireAtPoint(schHorWires, schMaxHorWidth, false, y, x, bestWire, wire);
+    bestWire = findFirstTrackWireAtPoint(schVertWires, schMaxVertHeight, true, x, y, bestWire,
+        wire);
+    return bestWire;
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -253,13 +468,13 @@ static void connectWires(
     schForeachSchemWire(schem, wire) {
         x = schWireGetX1(wire);
         y = schWireGetY1(wire);
-        otherWire = findOtherWireAtPoint(schem, wire, x, y);
+        otherWire = findOtherWireAtPoint(wire, x, y);
         if(otherWire != schWireNull) {
             schConnCreate(wire, otherWire, x, y);
         }
         x = schWireGetX2(wire);
         y = schWireGetY2(wire);
-        otherWire = findOtherWireAtPoint(schem, wire, x, y);
+        otherWire = findOtherWireAtPoint(wire, x, y);
         if(otherWire != schWireNull) {
             schConnCreate(wire, otherWire, x, y);
         }
@@ -341,8 +556,6 @@ static schNet findNetFromNetAttr(
 
 /*--------------------------------------------------------------------------------------------------
   Add pins to nets they touch.  Be sure to build all nets for wires before calling this.
-
-  Note: speed this up with hash tables and sorted arrays
 --------------------------------------------------------------------------------------------------*/
 static void addPinsToNets(
     schSchem schem)
@@ -354,7 +567,7 @@ static void addPinsToNets(
 
     schForeachSchemComp(schem, comp) {
         schForeachCompPin(comp, pin) {
-             wire = findOtherWireAtPoint(schem, schWireNull, schPinGetX(pin), schPinGetY(pin));
+             wire = findOtherWireAtPoint(schWireNull, schPinGetX(pin), schPinGetY(pin));
              if(wire != schWireNull) {
                  net = schWireGetNet(wire);
                  utAssert(net != schNetNull);
@@ -445,6 +658,7 @@ static void buildNets(
     utSym netName;
     bool isBus;
 
+    buildWireIndex(schem);
     connectWires(schem);
     /* First, build named nets */
     schForeachSchemWire(schem, wire) {
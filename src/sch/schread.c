@@ -23,20 +23,16 @@
 #include <string.h>
 #include "sch.h"
 
-FILE *schFile;
 uint32 schLineNum;
 char *schFileName;
-static char *schLineBuf;
-static uint32 schLineLength, schLineSize;
+static char *schText, *schTextPos, *schTextEnd;
 
 /*--------------------------------------------------------------------------------------------------
   Initialize the read module
 --------------------------------------------------------------------------------------------------*/
 void schStartReader(void)
 {
-    schLineLength = 0;
-    schLineSize = 42;
-    schLineBuf = utNewA(char, schLineSize);
+    schText = NULL;
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -44,7 +40,34 @@ void schStartReader(void)
 --------------------------------------------------------------------------------------------------*/
 void schStopReader(void)
 {
-    utFree(schLineBuf);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Open the file, and set up to read lines from its text.
+--------------------------------------------------------------------------------------------------*/
+static bool openFile(
+    char *fileName)
+{
+    size_t length;
+
+    schFileName = fileName;
+    schLineNum = 1;
+    schText = schOpenFile(fileName, &length);
+    if(schText == NULL) {
+        return false;
+    }
+    schTextPos = schText;
+    schTextEnd = schText + length;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Close the file.
+--------------------------------------------------------------------------------------------------*/
+static void closeFile(void)
+{
+    schCloseFile(schText);
+    schText = NULL;
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -52,46 +75,66 @@ void schStopReader(void)
 --------------------------------------------------------------------------------------------------*/
 static int peekChar(void)
 {
-    int c = getc(schFile);
+    if(schTextPos == schTextEnd) {
+        return EOF;
+    }
+    return (uint8)*schTextPos;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Remove carriage returns from the line, in place.
+--------------------------------------------------------------------------------------------------*/
+static void removeReturns(
+    char *line,
+    char *end)
+{
+    char *p = memchr(line, '\r', end - line);
+    char *q;
 
-    ungetc(c, schFile);
-    return c;
+    if(p == NULL) {
+        return;
+    }
+    for(q = p; p < end; p++) {
+        if(*p != '\r') {
+            *q++ = *p;
+        }
+    }
+    *q = '\0';
 }
 
 /*--------------------------------------------------------------------------------------------------
-  Read the next line.
+  Read the next lines.  Rather than copying them, we terminate them in the file's text, and return
+  a pointer to them there.  Lines after the first are still separated by '\n'.  The text stays
+  valid until the file is closed.
 --------------------------------------------------------------------------------------------------*/
 static char *readLine(
     uint32 numLines)
 {
-    int c;
-
-    schLineLength = 0;
-    while(numLines-- != 0) {
-        utDo {
-            c = getc(schFile);
-        } utWhile(c != EOF && c != '\n') {
-            if(c != '\r') {
-                if(schLineLength == schLineSize) {
-                    schLineSize <<= 1;
-                    utResizeArray(schLineBuf, schLineSize);
-                }
-                schLineBuf[schLineLength++] = c;
-            }
-        } utRepeat;
-        if(c == '\n') {
+    char *line = schTextPos;
+    char *end = schTextPos;
+
+    if(schTextPos == schTextEnd) {
+        return NULL; /* End of input */
+    }
+    if(numLines == 0) {
+        numLines = 1;
+    }
+    while(numLines-- != 0 && schTextPos != schTextEnd) {
+        end = memchr(schTextPos, '\n', schTextEnd - schTextPos);
+        if(end == NULL) {
+            end = schTextEnd; /* The text is terminated with '\0' here */
+            schTextPos = schTextEnd;
+        } else {
+            schTextPos = end + 1;
             schLineNum++;
-        } else if(schLineLength == 0) {
-            return NULL; /* End of input */
         }
-        if(schLineLength == schLineSize) {
-            schLineSize <<= 1;
-            utResizeArray(schLineBuf, schLineSize);
-        }
-        schLineBuf[schLineLength++] = '\n';
     }
-    schLineBuf[schLineLength - 1] = '\0';
-    return schLineBuf;
+    *end = '\0';
+    if(end == schTextEnd && line[strspn(line, "\r")] == '\0') {
+        return NULL; /* Only carriage returns after the last newline */
+    }
+    removeReturns(line, end);
+    return line;
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -162,7 +205,7 @@ static schAttr readAttributes(void)
     utDo {
         objType = peekChar();
     } utWhile(objType == OBJ_TEXT) {
-        buf = utCopyString(readLine(1));
+        buf = readLine(1);
         attr = readAttr(buf);
         if(attr != schAttrNull) {
             if(firstAttr == schAttrNull) {
@@ -357,7 +400,6 @@ static schSchem readSchem(
             readComp(schem, buf);
             break;
         case OBJ_TEXT:
-            buf = utCopyString(buf);
             attr = readAttr(buf);
             if(attr != schAttrNull) {
                 if(lastAttr == schAttrNull) {
@@ -422,7 +464,6 @@ static schSymbol readSymbol(
             schWarning("Unexpected object in symbol");
             break;
         case OBJ_TEXT:
-            buf = utCopyString(buf);
             attr = readAttr(buf);
             if(attr != schAttrNull) {
                 if(lastAttr == schAttrNull) {
@@ -468,16 +509,13 @@ schSchem schReadSchem(
     utSym path;
 
     fileName = utFullPath(fileName);
-    schFileName = fileName;
-    schFile = fopen(fileName, "r");
-    schLineNum = 1;
-    if(schFile == NULL) {
+    if(!openFile(fileName)) {
         utWarning("Could not open file %s", fileName);
         return schSchemNull;
     }
     path = utSymCreate(utDirName(fileName));
     schem = readSchem(utSymCreate(utBaseName(fileName)), path);
-    fclose(schFile);
+    closeFile();
     if(schem != schSchemNull) {
         if(!schSchemPostProcess(schem, loadSubSchems)) {
             schSchemDestroy(schem);
@@ -499,15 +537,19 @@ schSymbol schReadSymbol(
 
     fileName = utFullPath(fileName);
     schFileName = fileName;
-    schFile = fopen(fileName, "r");
-    schLineNum = 1;
-    if(schFile == NULL) {
-        utWarning("Could not open file %s", fileName);
-        return schSymbolNull;
+    symbol = schReadCachedSymbol(fileName);
+    if(symbol == schSymbolNull) {
+        if(!openFile(fileName)) {
+            utWarning("Could not open file %s", fileName);
+            return schSymbolNull;
+        }
+        path = utSymCreate(utDirName(fileName));
+        symbol = readSymbol(utSymCreate(utBaseName(fileName)), path);
+        closeFile();
+        if(symbol != schSymbolNull) {
+            schCacheSymbol(fileName, symbol);
+        }
     }
-    path = utSymCreate(utDirName(fileName));
-    symbol = readSymbol(utSymCreate(utBaseName(fileName)), path);
-    fclose(schFile);
     if(symbol != schSymbolNull) {
         if(!schSymbolPostProcess(symbol, loadSubSchems)) {
             schSymbolDestroy(symbol);
@@ -37,22 +37,44 @@ utSym schFindAttrValue(
 }
 
 /*--------------------------------------------------------------------------------------------------
-  Create a unique net name in the schematic.
+  Find the unique name counters for the prefix in the schematic.  Create them if needed.
+--------------------------------------------------------------------------------------------------*/
+static schPrefix findOrCreateSchemPrefix(
+    schSchem schem,
+    utSym sym)
+{
+    schPrefix prefix = schSchemFindPrefix(schem, sym);
+
+    if(prefix == schPrefixNull) {
+        prefix = schPrefixAlloc();
+        schPrefixSetSym(prefix, sym);
+        schSchemInsertPrefix(schem, prefix);
+    }
+    return prefix;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a unique net name in the schematic.  Suffixes are counted per prefix, so we don't
+  re-probe names we've already handed out.
 --------------------------------------------------------------------------------------------------*/
 utSym schSchemCreateUniqueNetName(
     schSchem schem,
     char *name)
 {
     utSym sym = utSymCreate(name);
-    uint32 x = 0;
+    schPrefix prefix;
+    uint32 x;
 
     if(schSchemFindNet(schem, sym) == schNetNull) {
         return sym;
     }
+    prefix = findOrCreateSchemPrefix(schem, sym);
+    x = schPrefixGetNextNetSuffix(prefix);
     do {
         sym = utSymCreateFormatted("%s%u", name, x);
         x++;
     } while(schSchemFindNet(schem, sym) != schNetNull);
+    schPrefixSetNextNetSuffix(prefix, x);
     return sym;
 }
 
@@ -64,15 +86,19 @@ utSym schSchemCreateUniqueCompName(
     char *name)
 {
     utSym sym = utSymCreate(name);
-    uint32 x = 0;
+    schPrefix prefix;
+    uint32 x;
 
     if(schSchemFindComp(schem, sym) == schCompNull) {
         return sym;
     }
+    prefix = findOrCreateSchemPrefix(schem, sym);
+    x = schPrefixGetNextCompSuffix(prefix);
     do {
         sym = utSymCreateFormatted("%s%u", name, x);
         x++;
     } while(schSchemFindComp(schem, sym) != schCompNull);
+    schPrefixSetNextCompSuffix(prefix, x);
     return sym;
 }
 
@@ -24,6 +24,12 @@ void cirStart(dbDesign design, dbSpiceTargetType targetType);
 void cirStop(void);
 bool cirBuildDevices(void);
 
+/* Views of a design, for writing it without changing it */
+void cirStartView(dbDesign design);
+void cirViewNetlist(dbNetlist netlist);
+char *cirViewGetNetName(dbNet net);
+char *cirViewGetNetlistName(dbNetlist netlist);
+
 extern cirRoot cirTheRoot;
 extern char *cirDeviceStringPtr;
 
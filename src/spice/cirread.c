@@ -20,15 +20,32 @@
   Read in a SPICE design.
 --------------------------------------------------------------------------------------------------*/
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
 #include "cir.h"
 
+/* Bump this whenever the library index format changes */
+#define CIR_INDEX_VERSION 2
+
 static dbDesign cirCurrentDesign, cirCurrentLibrary;
 static dbNetlist cirCurrentNetlist, cirLastNetlist;
 static char *cirLine;
 static uint32 cirLinePosition, cirLineLength, cirMaxLineLength;
 static char *cirFileName;
+static char *cirText; /* The whole input file */
+static size_t cirTextLength, cirTextPos;
+static bool cirTextMapped;
 static bool cirSkipSubcircuit;
 static bool cirCheckParameters;
 static bool dollarAsComment = false; 
@@ -101,59 +118,162 @@ static void freeUnusedDeviceNetlists(void)
     } cirEndRootDevice;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Open the input file, and get its text.  Where we can, we map it into memory, so large netlists
+  are read straight from the page cache.  Return false if it can't be opened.
+--------------------------------------------------------------------------------------------------*/
+static bool openInput(
+    char *fileName)
+{
+    FILE *file;
+    size_t length;
+#ifndef _WIN32
+    struct stat fileStat;
+    int fd = open(fileName, O_RDONLY);
+
+    if(fd < 0) {
+        return false;
+    }
+    cirTextPos = 0;
+    if(!fstat(fd, &fileStat) && fileStat.st_size > 0) {
+        cirText = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(cirText != MAP_FAILED) {
+            close(fd);
+            madvise(cirText, fileStat.st_size, MADV_SEQUENTIAL);
+            cirTextLength = fileStat.st_size;
+            cirTextMapped = true;
+            return true;
+        }
+    }
+    close(fd);
+#endif
+    file = fopen(fileName, "rb");
+    if(file == NULL) {
+        return false;
+    }
+    cirTextPos = 0;
+    cirTextLength = 0;
+    length = 1 << 16;
+    cirText = utNewA(char, length);
+    while(!feof(file) && !ferror(file)) {
+        if(cirTextLength == length) {
+            length <<= 1;
+            utResizeArray(cirText, length);
+        }
+        cirTextLength += fread(cirText + cirTextLength, 1, length - cirTextLength, file);
+    }
+    fclose(file);
+    cirTextMapped = false;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Close the input file.
+--------------------------------------------------------------------------------------------------*/
+static void closeInput(void)
+{
+#ifndef _WIN32
+    if(cirTextMapped) {
+        munmap(cirText, cirTextLength);
+        cirText = NULL;
+        return;
+    }
+#endif
+    utFree(cirText);
+    cirText = NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Return the wall clock time in seconds.
+--------------------------------------------------------------------------------------------------*/
+static double findTime(void)
+{
+#ifndef _WIN32
+    struct timeval now;
+
+    gettimeofday(&now, NULL);
+    return now.tv_sec + now.tv_usec*1.0e-6;
+#else
+    return (double)time(NULL);
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Report how fast we read the input file.
+--------------------------------------------------------------------------------------------------*/
+static void reportThroughput(
+    double startTime)
+{
+    double seconds = findTime() - startTime;
+
+    if(utDebugVal > 0 && seconds > 0.0) {
+        utDebug("Read %s: %.1f MB in %.2f seconds, %.1f MB/s\n", cirFileName,
+            cirTextLength/1.0e6, seconds, cirTextLength/(1.0e6*seconds));
+    }
+}
+
 /*--------------------------------------------------------------------------------------------------
   Just skip the current line.
 --------------------------------------------------------------------------------------------------*/
 static void skipLine(void)
 {
-    int c;
+    char *p = memchr(cirText + cirTextPos, '\n', cirTextLength - cirTextPos);
 
-    do {
-        c = getc(cirFile);
-        if(c == '\n') {
-            cirLineNum++;
-            return;
-        }
-    } while(c != EOF);
+    if(p == NULL) {
+        cirTextPos = cirTextLength;
+        return;
+    }
+    cirLineNum++;
+    cirTextPos = p + 1 - cirText;
 }
 
 /*--------------------------------------------------------------------------------------------------
-  Add a character to the current line.
+  Add characters to the current line.
 --------------------------------------------------------------------------------------------------*/
-static void addChar(
-    char c)
+static void addChars(
+    char *chars,
+    uint32 length)
 {
-    if(cirLineLength == cirMaxLineLength) {
-        cirMaxLineLength <<= 1;
+    if(cirLineLength + length > cirMaxLineLength) {
+        do {
+            cirMaxLineLength <<= 1;
+        } while(cirLineLength + length > cirMaxLineLength);
         utResizeArray(cirLine, cirMaxLineLength);
     }
-    cirLine[cirLineLength++] = c;
+    memcpy(cirLine + cirLineLength, chars, length);
+    cirLineLength += length;
 }
 
 /*--------------------------------------------------------------------------------------------------
-  Read a line into the local buffer.  Return false if we're at EOF.
+  Read a line into the local buffer.  Return false if we're at EOF.  Leading space, including
+  blank lines, is skipped.  The rest of the line is found with memchr, and copied in one go.
 --------------------------------------------------------------------------------------------------*/
 static bool readLinePart(void)
 {
-    int c;
+    char *p = cirText + cirTextPos;
+    char *end = cirText + cirTextLength;
+    char *lineEnd;
 
-    do {
-        c = getc(cirFile);
-        if(c == '\n') {
+    while(p != end && (uint8)*p <= ' ') {
+        if(*p++ == '\n') {
             cirLineNum++;
         }
-    } while(c != EOF && c <= ' ');
-    if(c == EOF) {
+    }
+    if(p == end) {
+        cirTextPos = cirTextLength;
         return false;
     }
-    while(c != EOF && c != '\n') {
-        addChar(c);
-        c = getc(cirFile);
+    lineEnd = memchr(p, '\n', end - p);
+    if(lineEnd == NULL) {
+        lineEnd = end;
     }
-    if(c == '\n') {
+    addChars(p, lineEnd - p);
+    if(lineEnd != end) {
         cirLineNum++;
+        lineEnd++;
     }
-    addChar('\0');
+    cirTextPos = lineEnd - cirText;
+    addChars("", 1);
     return true;
 }
 
@@ -162,18 +282,19 @@ static bool readLinePart(void)
 --------------------------------------------------------------------------------------------------*/
 static bool lineStartsWithPlus(void)
 {
-    int c;
+    char *p = cirText + cirTextPos;
+    char *end = cirText + cirTextLength;
 
-    do {
-        c = getc(cirFile);
-        if(c == '\n') {
+    while(p != end && (uint8)*p < ' ') {
+        if(*p++ == '\n') {
             cirLineNum++;
         }
-    } while(c != EOF && c < ' ');
-    if(c == '+') {
+    }
+    cirTextPos = p - cirText;
+    if(p != end && *p == '+') {
+        cirTextPos++;
         return true;
     }
-    ungetc(c, cirFile);
     return false;
 }
 
@@ -203,7 +324,9 @@ static bool readLine(void)
     }
     while(lineStartsWithPlus()) {
         cirLine[cirLineLength - 1] = ' ';
-        readLinePart();
+        if(!readLinePart()) {
+            cirLine[cirLineLength - 1] = '\0'; /* A '+' with nothing after it ends the file */
+        }
     }
 
     /* totally the opposite of my experience, $ is a comment in hspice but not in CDL neither
@@ -566,6 +689,62 @@ static utSym findSubCircuitSym(void)
     return sym;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Build a new mport with the given name.
+--------------------------------------------------------------------------------------------------*/
+static dbMport buildMport(
+    utSym name)
+{
+    dbMport mport = dbMportCreate(cirCurrentNetlist, name, DB_PAS);
+    dbInst flag = dbFlagInstCreate(mport);
+    dbNet net = findOrCreateNet(name);
+
+    dbNetInsertPort(net, dbInstGetFirstPort(flag));
+    return mport;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the netlist of a libcell, with just the mports recorded in the library index.  Its body is
+  read after the current file, by readLazyLibraries.
+--------------------------------------------------------------------------------------------------*/
+static dbNetlist buildLibcellNetlist(
+    dbDesign design,
+    dbLibcell libcell)
+{
+    dbNetlist savedNetlist = cirCurrentNetlist;
+    dbNetlist netlist = dbNetlistCreate(design, dbLibcellGetSym(libcell), DB_SUBCIRCUIT, utSymNull);
+    uint32 xPort;
+
+    cirCurrentNetlist = netlist;
+    for(xPort = 0; xPort < dbLibcellGetNumPortSym(libcell); xPort++) {
+        buildMport(dbLibcellGetiPortSym(libcell, xPort));
+    }
+    cirCurrentNetlist = savedNetlist;
+    dbLibcellSetPending(libcell, true);
+    return netlist;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the netlist in the design.  If the design is a lazily read library, and the netlist is one
+  of its libcells we have not yet needed, build it now.
+--------------------------------------------------------------------------------------------------*/
+static dbNetlist findNetlist(
+    dbDesign design,
+    utSym name)
+{
+    dbNetlist netlist = dbDesignFindNetlist(design, name);
+    dbLibcell libcell;
+
+    if(netlist != dbNetlistNull) {
+        return netlist;
+    }
+    libcell = dbDesignFindLibcell(design, name);
+    if(libcell == dbLibcellNull) {
+        return dbNetlistNull;
+    }
+    return buildLibcellNetlist(design, libcell);
+}
+
 static bool executeUndefinedInstance(utSym name, utSym internalNetlistSym)
 {
     dbNetlist internalNetlist;
@@ -601,11 +780,12 @@ static bool executeInstance(void)
     }
     internalNetlistSym = findSubCircuitSym();
     if(internalNetlistSym != utSymNull) {
-        internalNetlist = dbDesignFindNetlist(cirCurrentDesign, internalNetlistSym);
-        if(cirCurrentLibrary != dbDesignNull) {
-            libraryNetlist = dbDesignFindNetlist(cirCurrentLibrary, internalNetlistSym);
-            if(internalNetlist == dbNetlistNull || (dbLibraryWins && libraryNetlist !=
-                    dbNetlistNull)) {
+        internalNetlist = findNetlist(cirCurrentDesign, internalNetlistSym);
+        /* Only look in the library when it will be used, so we don't read unused libcells */
+        if(cirCurrentLibrary != dbDesignNull && (internalNetlist == dbNetlistNull ||
+                dbLibraryWins)) {
+            libraryNetlist = findNetlist(cirCurrentLibrary, internalNetlistSym);
+            if(libraryNetlist != dbNetlistNull) {
                 internalNetlist = libraryNetlist;
             }
         }
@@ -626,20 +806,6 @@ static bool executeInstance(void)
     return true;
 }
 
-/*--------------------------------------------------------------------------------------------------
-  Build a new mport with the given name.
---------------------------------------------------------------------------------------------------*/
-static dbMport buildMport(
-    utSym name)
-{
-    dbMport mport = dbMportCreate(cirCurrentNetlist, name, DB_PAS);
-    dbInst flag = dbFlagInstCreate(mport);
-    dbNet net = findOrCreateNet(name);
-
-    dbNetInsertPort(net, dbInstGetFirstPort(flag));
-    return mport;
-}
-
 /*--------------------------------------------------------------------------------------------------
   Rename a mport with the given name. Create associated flag and net.
 --------------------------------------------------------------------------------------------------*/
@@ -1090,6 +1256,538 @@ static bool readSpice(void)
     return true;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Skip over the mports of a .subckt line.  This stops at the first parameter, just like
+  buildMports.
+--------------------------------------------------------------------------------------------------*/
+static void skipMports(void)
+{
+    utSym netName;
+    char c;
+    uint32 lastIdentifierPosition;
+
+    utDo {
+        lastIdentifierPosition = cirLinePosition;
+        netName = readNodeName();
+        c = cirPeekChar();
+    } utWhile(netName != utSymNull && c != '=') {
+    } utRepeat;
+    if(c == '=') {
+        /* Put the identifier back so it can be read as an attribute name */
+        cirLinePosition = lastIdentifierPosition;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read the body of a pending libcell.  Its mports were built from the index, so we just read the
+  parameters on the .subckt line, and then execute lines up to the .ends.
+--------------------------------------------------------------------------------------------------*/
+static bool readLibcellBody(
+    dbLibcell libcell)
+{
+    if(dbLibcellGetOffset(libcell) > cirTextLength) {
+        cirError("Unable to seek to sub-circuit %s", dbLibcellGetName(libcell));
+        return false;
+    }
+    cirTextPos = dbLibcellGetOffset(libcell);
+    cirLineNum = dbLibcellGetLineNum(libcell);
+    if(!readLine()) {
+        cirError("Sub-circuit %s not found -- is the library index stale?",
+            dbLibcellGetName(libcell));
+        return false;
+    }
+    skipSpace();
+    cirLinePosition++; /* Skip past the '.' */
+    if(utSymGetLowerSym(readIdentifier()) != cirSubcktSym ||
+            readIdentifier() != dbLibcellGetSym(libcell)) {
+        cirError("Sub-circuit %s not found -- is the library index stale?",
+            dbLibcellGetName(libcell));
+        return false;
+    }
+    cirCurrentNetlist = dbDesignFindNetlist(cirCurrentDesign, dbLibcellGetSym(libcell));
+    skipMports();
+    if(!addNetlistParameters()) {
+        return false;
+    }
+    while(cirCurrentNetlist != dbNetlistNull) {
+        if(!readLine()) {
+            cirError("Missing .ends for sub-circuit %s", dbLibcellGetName(libcell));
+            return false;
+        }
+        if(!executeLine()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the design has any libcells waiting to have their bodies read.
+--------------------------------------------------------------------------------------------------*/
+static bool designHasPendingLibcells(
+    dbDesign design)
+{
+    dbLibcell libcell;
+
+    dbForeachDesignLibcell(design, libcell) {
+        if(dbLibcellPending(libcell)) {
+            return true;
+        }
+    } dbEndDesignLibcell;
+    return false;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read the bodies of the pending libcells in the lazily read library.  Reading one can make
+  others pending, so we repeat until there are none left.  Libcells are destroyed once read,
+  since their netlists are then complete.
+--------------------------------------------------------------------------------------------------*/
+static bool readPendingLibcells(
+    dbDesign design)
+{
+    dbLibcell libcell;
+    char *fileName = dbDesignGetLazyFileName(design);
+    bool foundPending;
+    bool passed = true;
+
+    if(!openInput(fileName)) {
+        utWarning("Could not open file %s", fileName);
+        return false;
+    }
+    cirFileName = utNewA(char, strlen(fileName) + 1);
+    strcpy(cirFileName, fileName);
+    utLogMessage("Reading used sub-circuits from SPICE library %s", cirFileName);
+    cirCurrentDesign = design;
+    cirCurrentLibrary = dbDesignGetLibraryDesign(design);
+    cirSkipSubcircuit = false;
+    buildDeviceNetlists();
+    do {
+        foundPending = false;
+        dbSafeForeachDesignLibcell(design, libcell) {
+            if(passed && dbLibcellPending(libcell)) {
+                foundPending = true;
+                passed = readLibcellBody(libcell);
+                dbLibcellDestroy(libcell);
+            }
+        } dbEndSafeDesignLibcell;
+    } while(passed && foundPending);
+    freeUnusedDeviceNetlists();
+    closeInput();
+    utFree(cirFileName);
+    return passed;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read the bodies of libcells instantiated while reading the design.  Libraries can instantiate
+  cells from their own libraries, so we keep going until no design has pending libcells.
+--------------------------------------------------------------------------------------------------*/
+static bool readLazyLibraries(void)
+{
+    dbDesign design;
+    char *savedFileName = cirFileName;
+    bool readSome;
+    bool passed = true;
+
+    do {
+        readSome = false;
+        dbForeachRootDesign(dbTheRoot, design) {
+            if(passed && designHasPendingLibcells(design)) {
+                passed = readPendingLibcells(design);
+                readSome = true;
+            }
+        } dbEndRootDesign;
+    } while(passed && readSome);
+    cirFileName = savedFileName;
+    return passed;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a new libcell.  As when reading the whole library, only the first definition counts, so
+  return dbLibcellNull if the sub-circuit already exists.
+--------------------------------------------------------------------------------------------------*/
+static dbLibcell libcellCreate(
+    utSym name,
+    uint64 offset,
+    uint32 lineNum)
+{
+    dbLibcell libcell;
+
+    if(dbDesignFindLibcell(cirCurrentDesign, name) != dbLibcellNull ||
+            dbDesignFindNetlist(cirCurrentDesign, name) != dbNetlistNull) {
+        return dbLibcellNull;
+    }
+    libcell = dbLibcellAlloc();
+    dbLibcellSetSym(libcell, name);
+    dbLibcellSetOffset(libcell, offset);
+    dbLibcellSetLineNum(libcell, lineNum);
+    dbDesignInsertLibcell(cirCurrentDesign, libcell);
+    return libcell;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a port name to the libcell.
+--------------------------------------------------------------------------------------------------*/
+static void libcellAddPort(
+    dbLibcell libcell,
+    utSym name)
+{
+    uint32 numPorts = dbLibcellGetNumPortSym(libcell);
+
+    dbLibcellResizePortSyms(libcell, numPorts + 1);
+    dbLibcellSetiPortSym(libcell, numPorts, name);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a libcell for the .subckt line.  Port names are found the same way buildMports finds them.
+--------------------------------------------------------------------------------------------------*/
+static bool indexSubckt(
+    uint64 offset,
+    uint32 lineNum)
+{
+    dbLibcell libcell;
+    utSym netlistName = readIdentifier();
+    utSym netName, lastNetName = utSymNull;
+    char c;
+
+    if(netlistName == utSymNull) {
+        cirError("Bad sub-circuit name");
+        return false;
+    }
+    libcell = libcellCreate(netlistName, offset, lineNum);
+    if(libcell == dbLibcellNull) {
+        cirError("Redefinition of sub-circuit %s -- using old circuit", utSymGetName(netlistName));
+        return true;
+    }
+    utDo {
+        netName = readNodeName();
+        c = cirPeekChar();
+    } utWhile(netName != utSymNull && c != '=') {
+        if(lastNetName != utSymNull) {
+            libcellAddPort(libcell, lastNetName);
+        }
+        lastNetName = netName;
+    } utRepeat;
+    if(c != '\0' && c != '=') {
+        cirError("Unexpected character '%c'", c);
+        return false;
+    }
+    if(lastNetName != utSymNull) {
+        libcellAddPort(libcell, lastNetName);
+    }
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Scan the library file, adding a libcell for each .subckt, and executing .global directives.
+  Nothing else is parsed.
+--------------------------------------------------------------------------------------------------*/
+static bool scanLibrary(void)
+{
+    utSym directive;
+    uint64 offset;
+    uint32 lineNum;
+
+    skipLine(); /* The first line is a comment */
+    utDo {
+        offset = cirTextPos;
+        lineNum = cirLineNum;
+    } utWhile(readLine()) {
+        if(skipSpace() == '.') {
+            cirLinePosition++; /* Skip past the '.' */
+            directive = utSymGetLowerSym(readIdentifier());
+            if(directive == cirSubcktSym) {
+                if(!indexSubckt(offset, lineNum)) {
+                    return false;
+                }
+            } else if(directive == cirGlobalSym) {
+                if(!executeGlobal()) {
+                    return false;
+                }
+            }
+        }
+    } utRepeat;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read the next space separated word in the line.  Return NULL if there are no more.
+--------------------------------------------------------------------------------------------------*/
+static char *readWord(void)
+{
+    uint32 startPosition;
+
+    if(skipSpace() == '\0') {
+        return NULL;
+    }
+    startPosition = cirLinePosition;
+    while(cirPeekChar() > ' ') {
+        cirLinePosition++;
+    }
+    if(cirPeekChar() != '\0') {
+        cirLine[cirLinePosition++] = '\0';
+    }
+    return cirLine + startPosition;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read a libcell line from the index: its name, offset, line number, and port names.
+--------------------------------------------------------------------------------------------------*/
+static bool readIndexLibcell(void)
+{
+    dbLibcell libcell;
+    char *name = readWord();
+    char *offset = readWord();
+    char *lineNum = readWord();
+    char *portName;
+
+    if(name == NULL || offset == NULL || lineNum == NULL) {
+        return false;
+    }
+    libcell = libcellCreate(utSymCreate(name), strtoull(offset, NULL, 10),
+        strtoul(lineNum, NULL, 10));
+    if(libcell == dbLibcellNull) {
+        return true;
+    }
+    while((portName = readWord()) != NULL) {
+        libcellAddPort(libcell, utSymCreate(portName));
+    }
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read the globals on a G line of the index.  New ones are added to the globals array, so they can
+  be destroyed if the index turns out to be corrupt.
+--------------------------------------------------------------------------------------------------*/
+static void readIndexGlobals(
+    dbGlobal **globalsPtr,
+    uint32 *numGlobalsPtr,
+    uint32 *maxGlobalsPtr)
+{
+    dbGlobal global;
+    utSym name;
+    char *word;
+
+    while((word = readWord()) != NULL) {
+        name = utSymCreate(word);
+        if(dbDesignFindGlobal(cirCurrentDesign, name) == dbGlobalNull) {
+            global = dbGlobalCreate(cirCurrentDesign, name);
+            if(*numGlobalsPtr == *maxGlobalsPtr) {
+                *maxGlobalsPtr <<= 1;
+                utResizeArray(*globalsPtr, *maxGlobalsPtr);
+            }
+            (*globalsPtr)[(*numGlobalsPtr)++] = global;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Check the E line at the end of the index, which holds the number of G and S lines before it.
+--------------------------------------------------------------------------------------------------*/
+static bool readIndexEnd(
+    uint32 numGlobalLines,
+    uint32 numLibcellLines)
+{
+    char *numGlobals = readWord();
+    char *numLibcells = readWord();
+
+    if(numGlobals == NULL || numLibcells == NULL || readWord() != NULL) {
+        return false;
+    }
+    return strtoul(numGlobals, NULL, 10) == numGlobalLines &&
+        strtoul(numLibcells, NULL, 10) == numLibcellLines;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read the library index, if it was written for this version of the library file.  Return false
+  if it can't be used, in which case no libcells or globals read from it are left in the design.
+  An index is only complete if it ends with an E line that counts the lines before it.
+--------------------------------------------------------------------------------------------------*/
+static bool readLibraryIndex(
+    char *indexFileName,
+    char *header)
+{
+    dbLibcell libcell;
+    dbGlobal *globals;
+    char *word;
+    uint32 numGlobals = 0, maxGlobals = 16;
+    uint32 numGlobalLines = 0, numLibcellLines = 0;
+    uint32 xGlobal;
+    bool passed = true, ended = false;
+
+    if(!openInput(indexFileName)) {
+        return false;
+    }
+    cirLineNum = 0;
+    if(!readLine() || strcmp(cirLine, header)) {
+        closeInput();
+        return false;
+    }
+    globals = utNewA(dbGlobal, maxGlobals);
+    while(passed && readLine()) {
+        word = readWord();
+        if(word == NULL || ended) {
+            passed = false;
+        } else if(!strcmp(word, "G")) {
+            readIndexGlobals(&globals, &numGlobals, &maxGlobals);
+            numGlobalLines++;
+        } else if(!strcmp(word, "S")) {
+            passed = readIndexLibcell();
+            numLibcellLines++;
+        } else if(!strcmp(word, "E")) {
+            passed = readIndexEnd(numGlobalLines, numLibcellLines);
+            ended = true;
+        } else {
+            passed = false;
+        }
+    }
+    closeInput();
+    if(!passed || !ended) {
+        utWarning("SPICE library index %s is corrupt, rebuilding it", indexFileName);
+        dbSafeForeachDesignLibcell(cirCurrentDesign, libcell) {
+            dbLibcellDestroy(libcell);
+        } dbEndSafeDesignLibcell;
+        for(xGlobal = 0; xGlobal < numGlobals; xGlobal++) {
+            dbGlobalDestroy(globals[xGlobal]);
+        }
+        passed = false;
+    }
+    utFree(globals);
+    return passed;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write the library index, so later runs don't have to scan the library file.  It is written to a
+  temporary file that is then renamed, so a run that dies part way through never leaves a partial
+  index behind.
+--------------------------------------------------------------------------------------------------*/
+static void writeLibraryIndex(
+    char *indexFileName,
+    char *header)
+{
+    char *tempFileName = utNewA(char, strlen(indexFileName) + 5);
+    FILE *file;
+    dbGlobal global;
+    dbLibcell libcell;
+    uint32 numGlobals = 0, numLibcells = 0;
+    uint32 xPort;
+    bool failed;
+
+    sprintf(tempFileName, "%s.tmp", indexFileName);
+    file = fopen(tempFileName, "w");
+    if(file == NULL) {
+        utWarning("Unable to write SPICE library index %s", indexFileName);
+        utFree(tempFileName);
+        return;
+    }
+    fprintf(file, "%s\n", header);
+    dbForeachDesignGlobal(cirCurrentDesign, global) {
+        fprintf(file, "G %s\n", dbGlobalGetName(global));
+        numGlobals++;
+    } dbEndDesignGlobal;
+    dbForeachDesignLibcell(cirCurrentDesign, libcell) {
+        fprintf(file, "S %s %llu %u", dbLibcellGetName(libcell),
+            (unsigned long long)dbLibcellGetOffset(libcell), dbLibcellGetLineNum(libcell));
+        for(xPort = 0; xPort < dbLibcellGetNumPortSym(libcell); xPort++) {
+            fprintf(file, " %s", utSymGetName(dbLibcellGetiPortSym(libcell, xPort)));
+        }
+        fprintf(file, "\n");
+        numLibcells++;
+    } dbEndDesignLibcell;
+    fprintf(file, "E %u %u\n", numGlobals, numLibcells);
+    failed = ferror(file);
+    if(fclose(file) != 0) {
+        failed = true;
+    }
+    if(failed || rename(tempFileName, indexFileName) != 0) {
+        utWarning("Unable to write SPICE library index %s", indexFileName);
+        remove(tempFileName);
+    }
+    utFree(tempFileName);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Set the library file that the design's libcells are read from.
+--------------------------------------------------------------------------------------------------*/
+static void setLazyFileName(
+    dbDesign design,
+    char *fileName)
+{
+    dbDesignResizeLazyFileNames(design, strlen(fileName) + 1);
+    strcpy(dbDesignGetLazyFileName(design), fileName);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Index a SPICE library rather than reading it.  Each .subckt becomes a libcell that records its
+  offset and ports, and its netlist is only read when a later cirReadDesign instantiates it.  The
+  index is saved next to the library file, and reused while the library file is unchanged.
+--------------------------------------------------------------------------------------------------*/
+dbDesign cirIndexLibrary(
+    char *libraryName,
+    char *fileName,
+    dbDesign libDesign)
+{
+    dbDesign design = dbDesignNull;
+    utSym designSym = utSymCreate(libraryName);
+    dbDevspec devspec = dbFindCurrentDevspec();
+    struct stat fileStat;
+    char *indexFileName, *header;
+
+    if(stat(fileName, &fileStat)) {
+        utWarning("Could not open file %s", fileName);
+        return dbDesignNull;
+    }
+    utLogMessage("Indexing SPICE library %s", fileName);
+    cirFileName = utNewA(char, strlen(fileName) + 1);
+    strcpy(cirFileName, fileName);
+    indexFileName = utNewA(char, strlen(fileName) + 5);
+    sprintf(indexFileName, "%s.idx", fileName);
+    dollarAsComment = dbDevspecDollarAsComment(devspec);
+    /* The index is only good for the same library file, parsed the same way */
+    header = utNewA(char, 100);
+    sprintf(header, "* gnetman SPICE library index %u %llu %lu %u %u", CIR_INDEX_VERSION,
+        (unsigned long long)fileStat.st_size, (unsigned long)fileStat.st_mtime, dbSpiceTarget,
+        dollarAsComment);
+    cirMaxLineLength = 80;
+    cirLine = utNewA(char, cirMaxLineLength);
+    initKeywords();
+    if(!utSetjmp()) {
+        design = dbRootFindDesign(dbTheRoot, designSym);
+        if(design == dbDesignNull) {
+            design = dbDesignCreate(designSym, libDesign);
+        }
+        cirCurrentDesign = design;
+        setLazyFileName(design, fileName);
+        if(readLibraryIndex(indexFileName, header)) {
+            utLogMessage("Using SPICE library index %s", indexFileName);
+        } else {
+            if(!openInput(fileName)) {
+                utWarning("Could not open file %s", fileName);
+                dbDesignDestroy(design);
+                design = dbDesignNull;
+            } else {
+                cirLineNum = 0;
+                if(scanLibrary()) {
+                    writeLibraryIndex(indexFileName, header);
+                } else {
+                    cirError("Unsuccessful SPICE library indexing");
+                    dbDesignDestroy(design);
+                    design = dbDesignNull;
+                }
+                closeInput();
+            }
+        }
+    }
+    utUnsetjmp();
+    if(cirText != NULL) {
+        closeInput();
+    }
+    utFree(cirFileName);
+    utFree(indexFileName);
+    utFree(header);
+    utFree(cirLine);
+    return design;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Read in a SPICE design.
 --------------------------------------------------------------------------------------------------*/
@@ -1102,6 +1800,7 @@ dbDesign cirReadDesign(
     dbDesign design = dbDesignNull;
     utSym designSym = utSymCreate(designName);
     dbDevspec devspec = dbFindCurrentDevspec();
+    double startTime;
 
     utLogMessage("Reading SPICE file %s", fileName);
     cirFileName = utNewA(char, strlen(fileName) + 1);
@@ -1118,8 +1817,7 @@ dbDesign cirReadDesign(
         if(!cirBuildDevices()) {
             utWarning("Could not build SPICE device configuration data");
         } else {
-            cirFile = fopen(fileName, "r");
-            if(cirFile == NULL) {
+            if(!openInput(fileName)) {
                 utWarning("Could not open file %s", cirFileName);
             } else {
                 cirCurrentDesign = dbRootFindDesign(dbTheRoot, designSym);
@@ -1131,8 +1829,10 @@ dbDesign cirReadDesign(
                 cirCurrentNetlist = dbNetlistNull;
                 cirLastNetlist = dbNetlistNull;
 
-               
+                startTime = findTime();
                 readSpiceResult = readSpice();
+                reportThroughput(startTime);
+                closeInput();
 
                 if(readSpiceResult || cirLastNetlist == dbNetlistNull) {
 
@@ -1141,6 +1841,9 @@ dbDesign cirReadDesign(
 
                     design = cirCurrentDesign;
                     dbDesignSetRootNetlist(design, cirLastNetlist);
+                    if(!readLazyLibraries()) {
+                        utWarning("Unsuccessful SPICE library parsing");
+                    }
                 } else {
                     if(readSpiceResult == false) {
                         cirError("Unsuccessful SPICE parsing");
@@ -1155,6 +1858,9 @@ dbDesign cirReadDesign(
     }
     cirStop();
     utUnsetjmp();
+    if(cirText != NULL) {
+        closeInput();
+    }
     utFree(cirFileName);
     utFree(cirLine);
     return design;
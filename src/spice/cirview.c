@@ -0,0 +1,643 @@
+/*
+ * Copyright (C) 2003 ViASIC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program; if not, write to the Free Software 
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111 USA
+ */
+
+/*--------------------------------------------------------------------------------------------------
+  Views of a design, for writing it without changing it.
+
+  Writing SPICE normally cleans up the design first: net names are set to match mports, power
+  instances become global nets, instance arrays are exploded, and names are munged to be
+  alpha-numeric.  Views show the design the way those clean-ups would leave it.  They mirror each
+  step, including the order objects end up in and the unique name suffixes handed out, so the
+  netlist written from views is the same.  Design level names are worked out up front, since any
+  netlist may refer to them, but a netlist's own views are only built when it is written.
+--------------------------------------------------------------------------------------------------*/
+#include <string.h>
+#include "cir.h"
+
+static dbDesign cirViewDesign;
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the instance is a power instance that would be converted to a global net.
+--------------------------------------------------------------------------------------------------*/
+static bool isPowerInst(
+    dbInst inst)
+{
+    dbNetlist internalNetlist = dbInstGetInternalNetlist(inst);
+
+    return dbNetlistGetType(internalNetlist) == DB_POWER &&
+        dbNetlistGetFirstMport(internalNetlist) != dbMportNull;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the global view with the name it had before munging.
+--------------------------------------------------------------------------------------------------*/
+static cirGlobalView findGlobalView(
+    utSym oldSym)
+{
+    cirGlobalView globalView;
+
+    cirForeachRootGlobalView(cirTheRoot, globalView) {
+        if(cirGlobalViewGetOldSym(globalView) == oldSym) {
+            return globalView;
+        }
+    } cirEndRootGlobalView;
+    return cirGlobalViewNull;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build a global view.  New globals go first, just like dbGlobalCreate puts them.
+--------------------------------------------------------------------------------------------------*/
+static cirGlobalView globalViewCreate(
+    dbGlobal global,
+    utSym sym,
+    bool first)
+{
+    cirGlobalView globalView = cirGlobalViewAlloc();
+
+    cirGlobalViewSetGlobal(globalView, global);
+    cirGlobalViewSetOldSym(globalView, sym);
+    cirGlobalViewSetSym(globalView, sym);
+    if(first) {
+        cirRootInsertGlobalView(cirTheRoot, globalView);
+    } else {
+        cirRootAppendGlobalView(cirTheRoot, globalView);
+    }
+    if(global != dbGlobalNull) {
+        cirGlobalSetView(global, globalView);
+    }
+    return globalView;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the unique name counters for the prefix in the netlist.  They start from the netlist's own.
+--------------------------------------------------------------------------------------------------*/
+static cirPrefixView findPrefixView(
+    dbNetlist netlist,
+    utSym sym)
+{
+    cirPrefixView prefixView = cirNetlistFindPrefixView(netlist, sym);
+    dbPrefix prefix;
+
+    if(prefixView == cirPrefixViewNull) {
+        prefixView = cirPrefixViewAlloc();
+        cirPrefixViewSetSym(prefixView, sym);
+        prefix = dbNetlistFindPrefix(netlist, sym);
+        if(prefix != dbPrefixNull) {
+            cirPrefixViewSetNextNetSuffix(prefixView, dbPrefixGetNextNetSuffix(prefix));
+            cirPrefixViewSetNextInstSuffix(prefixView, dbPrefixGetNextInstSuffix(prefix));
+            cirPrefixViewSetNextMportSuffix(prefixView, dbPrefixGetNextMportSuffix(prefix));
+        }
+        cirNetlistInsertPrefixView(netlist, prefixView);
+    }
+    return prefixView;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the unique name counters for the prefix in the design.  They start from the design's own.
+--------------------------------------------------------------------------------------------------*/
+static cirDesignPrefixView findDesignPrefixView(
+    utSym sym)
+{
+    cirDesignPrefixView prefixView = cirRootFindDesignPrefixView(cirTheRoot, sym);
+    dbPrefix prefix;
+
+    if(prefixView == cirDesignPrefixViewNull) {
+        prefixView = cirDesignPrefixViewAlloc();
+        cirDesignPrefixViewSetSym(prefixView, sym);
+        prefix = dbDesignFindPrefix(cirViewDesign, sym);
+        if(prefix != dbPrefixNull) {
+            cirDesignPrefixViewSetNextNetlistSuffix(prefixView,
+                dbPrefixGetNextNetlistSuffix(prefix));
+            cirDesignPrefixViewSetNextGlobalSuffix(prefixView, dbPrefixGetNextGlobalSuffix(prefix));
+        }
+        cirRootInsertDesignPrefixView(cirTheRoot, prefixView);
+    }
+    return prefixView;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if a name is used by a global.  Before the globals are munged, that is the design's
+  own globals.  After, it is the global views.
+--------------------------------------------------------------------------------------------------*/
+static bool globalNameUsed(
+    utSym sym,
+    bool globalsMunged)
+{
+    if(globalsMunged) {
+        return cirRootFindGlobalView(cirTheRoot, sym) != cirGlobalViewNull;
+    }
+    return dbDesignFindGlobal(cirViewDesign, sym) != dbGlobalNull;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a unique net name in the netlist view, like dbNetlistCreateUniqueNetName.
+--------------------------------------------------------------------------------------------------*/
+static utSym createUniqueNetName(
+    dbNetlist netlist,
+    char *name,
+    bool globalsMunged)
+{
+    utSym sym = utSymCreate(name);
+    cirPrefixView prefixView;
+    uint32 x;
+
+    if(cirNetlistFindNetView(netlist, sym) == cirNetViewNull) {
+        return sym;
+    }
+    prefixView = findPrefixView(netlist, sym);
+    x = cirPrefixViewGetNextNetSuffix(prefixView);
+    do {
+        sym = utSymCreateFormatted("%s%u", name, x);
+        x++;
+    } while(cirNetlistFindNetView(netlist, sym) != cirNetViewNull ||
+        globalNameUsed(sym, globalsMunged));
+    cirPrefixViewSetNextNetSuffix(prefixView, x);
+    return sym;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a unique inst name in the netlist view, like dbNetlistCreateUniqueInstName.
+--------------------------------------------------------------------------------------------------*/
+static utSym createUniqueInstName(
+    dbNetlist netlist,
+    char *name)
+{
+    utSym sym = utSymCreate(name);
+    cirPrefixView prefixView;
+    uint32 x;
+
+    if(cirNetlistFindInstView(netlist, sym) == cirInstViewNull) {
+        return sym;
+    }
+    prefixView = findPrefixView(netlist, sym);
+    x = cirPrefixViewGetNextInstSuffix(prefixView);
+    do {
+        sym = utSymCreateFormatted("%s%u", name, x);
+        x++;
+    } while(cirNetlistFindInstView(netlist, sym) != cirInstViewNull);
+    cirPrefixViewSetNextInstSuffix(prefixView, x);
+    return sym;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a unique mport name in the netlist view, like dbNetlistCreateUniqueMportName.
+--------------------------------------------------------------------------------------------------*/
+static utSym createUniqueMportName(
+    dbNetlist netlist,
+    char *name)
+{
+    utSym sym = utSymCreate(name);
+    cirPrefixView prefixView;
+    uint32 x;
+
+    if(cirNetlistFindMportView(netlist, sym) == cirMportViewNull) {
+        return sym;
+    }
+    prefixView = findPrefixView(netlist, sym);
+    x = cirPrefixViewGetNextMportSuffix(prefixView);
+    do {
+        sym = utSymCreateFormatted("%s%u", name, x);
+        x++;
+    } while(cirNetlistFindMportView(netlist, sym) != cirMportViewNull);
+    cirPrefixViewSetNextMportSuffix(prefixView, x);
+    return sym;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a unique netlist name in the design view, like dbDesignCreateUniqueNetlistName.
+--------------------------------------------------------------------------------------------------*/
+static utSym createUniqueNetlistName(
+    char *name)
+{
+    utSym sym = utSymCreate(name);
+    cirDesignPrefixView prefixView;
+    uint32 x;
+
+    if(cirRootFindNetlistView(cirTheRoot, sym) == cirNetlistViewNull) {
+        return sym;
+    }
+    prefixView = findDesignPrefixView(sym);
+    x = cirDesignPrefixViewGetNextNetlistSuffix(prefixView);
+    do {
+        sym = utSymCreateFormatted("%s%u", name, x);
+        x++;
+    } while(cirRootFindNetlistView(cirTheRoot, sym) != cirNetlistViewNull);
+    cirDesignPrefixViewSetNextNetlistSuffix(prefixView, x);
+    return sym;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Create a unique global name in the design view, like dbDesignCreateUniqueGlobalName.
+--------------------------------------------------------------------------------------------------*/
+static utSym createUniqueGlobalName(
+    char *name)
+{
+    utSym sym = utSymCreate(name);
+    cirDesignPrefixView prefixView;
+    uint32 x;
+
+    if(cirRootFindGlobalView(cirTheRoot, sym) == cirGlobalViewNull) {
+        return sym;
+    }
+    prefixView = findDesignPrefixView(sym);
+    x = cirDesignPrefixViewGetNextGlobalSuffix(prefixView);
+    do {
+        sym = utSymCreateFormatted("%s%u", name, x);
+        x++;
+    } while(cirRootFindGlobalView(cirTheRoot, sym) != cirGlobalViewNull);
+    cirDesignPrefixViewSetNextGlobalSuffix(prefixView, x);
+    return sym;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Munge the netlist names, like mungeNetlistNames in dbnetlist.c.
+--------------------------------------------------------------------------------------------------*/
+static void mungeNetlistNames(void)
+{
+    cirNetlistView netlistView;
+    char *newName;
+
+    cirForeachRootNetlistView(cirTheRoot, netlistView) {
+        newName = dbMungeName(cirNetlistViewGetName(netlistView));
+        cirRootRenameNetlistView(cirTheRoot, netlistView, utSymNull);
+        cirRootRenameNetlistView(cirTheRoot, netlistView, createUniqueNetlistName(newName));
+    } cirEndRootNetlistView;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Munge the global names, like mungeGlobalNames in dbnetlist.c.
+--------------------------------------------------------------------------------------------------*/
+static void mungeGlobalNames(void)
+{
+    cirGlobalView globalView;
+    char *newName;
+
+    cirForeachRootGlobalView(cirTheRoot, globalView) {
+        newName = dbMungeName(cirGlobalViewGetName(globalView));
+        cirRootRenameGlobalView(cirTheRoot, globalView, utSymNull);
+        cirRootRenameGlobalView(cirTheRoot, globalView, createUniqueGlobalName(newName));
+    } cirEndRootGlobalView;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the design level views: the netlist names, and the globals, including those power
+  instances would create.
+--------------------------------------------------------------------------------------------------*/
+void cirStartView(
+    dbDesign design)
+{
+    cirNetlistView netlistView;
+    dbNetlist netlist;
+    dbGlobal global;
+    dbInst inst;
+    utSym globalSym;
+
+    cirViewDesign = design;
+    dbForeachDesignGlobal(design, global) {
+        globalViewCreate(global, dbGlobalGetSym(global), false);
+    } dbEndDesignGlobal;
+    dbForeachDesignNetlist(design, netlist) {
+        netlistView = cirNetlistViewAlloc();
+        cirNetlistViewSetNetlist(netlistView, netlist);
+        cirNetlistViewSetSym(netlistView, dbNetlistGetSym(netlist));
+        cirRootAppendNetlistView(cirTheRoot, netlistView);
+        cirNetlistSetView(netlist, netlistView);
+        dbForeachNetlistInst(netlist, inst) {
+            if(isPowerInst(inst)) {
+                globalSym = dbMportGetSym(dbNetlistGetFirstMport(dbInstGetInternalNetlist(inst)));
+                if(findGlobalView(globalSym) == cirGlobalViewNull) {
+                    globalViewCreate(dbGlobalNull, globalSym, true);
+                }
+            }
+        } dbEndNetlistInst;
+    } dbEndDesignNetlist;
+    mungeNetlistNames();
+    mungeGlobalNames();
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Rename a net view, like dbNetRename, which moves the net to the front of the netlist's nets.
+--------------------------------------------------------------------------------------------------*/
+static void renameNetView(
+    dbNetlist netlist,
+    cirNetView netView,
+    utSym newName)
+{
+    cirNetlistRemoveNetView(netlist, netView);
+    cirNetViewSetSym(netView, newName);
+    cirNetlistInsertNetView(netlist, netView);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build a net view.
+--------------------------------------------------------------------------------------------------*/
+static cirNetView netViewCreate(
+    dbNetlist netlist,
+    dbNet net,
+    utSym sym,
+    cirGlobalView globalView)
+{
+    cirNetView netView = cirNetViewAlloc();
+
+    cirNetViewSetNet(netView, net);
+    cirNetViewSetSym(netView, sym);
+    cirNetViewSetGlobal(netView, globalView);
+    cirNetlistAppendNetView(netlist, netView);
+    if(net != dbNetNull) {
+        cirNetSetView(net, netView);
+    }
+    return netView;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the netlist's net views, and set net names to match mports, like
+  dbNetlistSetNetNamesToMatchMports.
+--------------------------------------------------------------------------------------------------*/
+static void buildNetViews(
+    dbNetlist netlist)
+{
+    cirNetView netView, otherView;
+    dbGlobal global;
+    dbMport mport;
+    dbPort port;
+    dbNet net;
+    utSym name;
+
+    dbForeachNetlistNet(netlist, net) {
+        global = dbNetGetGlobal(net);
+        netViewCreate(netlist, net, dbNetGetSym(net),
+            global == dbGlobalNull? cirGlobalViewNull : cirGlobalGetView(global));
+    } dbEndNetlistNet;
+    dbForeachNetlistMport(netlist, mport) {
+        port = dbMportGetFlagPort(mport);
+        if(port != dbPortNull) {
+            net = dbPortGetNet(port);
+            if(net != dbNetNull) {
+                netView = cirNetGetView(net);
+                if(cirNetViewVisited(netView)) {
+                    utWarning("Net %s connects to multiple mports in netlist %s",
+                        cirNetViewGetName(netView), dbNetlistGetName(netlist));
+                } else {
+                    cirNetViewSetVisited(netView, true);
+                    name = dbMportGetSym(mport);
+                    if(name != cirNetViewGetSym(netView)) {
+                        otherView = cirNetlistFindNetView(netlist, name);
+                        if(otherView != cirNetViewNull) {
+                            renameNetView(netlist, otherView,
+                                createUniqueNetName(netlist, utSymGetName(name), false));
+                        }
+                        renameNetView(netlist, netView, name);
+                    }
+                }
+            }
+        }
+    } dbEndNetlistMport;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Move the power instance's net onto a global net, like dbNetlistConvertPowerInstsToGlobals.
+--------------------------------------------------------------------------------------------------*/
+static void convertPowerInst(
+    dbNetlist netlist,
+    dbInst inst)
+{
+    dbMport mport = dbNetlistGetFirstMport(dbInstGetInternalNetlist(inst));
+    dbNet net = dbPortGetNet(dbInstGetFirstPort(inst));
+    cirGlobalView globalView = findGlobalView(dbMportGetSym(mport));
+    cirGlobalView netGlobalView;
+    cirNetView netView, globalNetView;
+
+    if(net == dbNetNull) {
+        return;
+    }
+    netView = cirNetGetView(net);
+    netGlobalView = cirNetViewGetGlobal(netView);
+    if(netGlobalView == cirGlobalViewNull) {
+        globalNetView = cirNetlistFindNetView(netlist, cirGlobalViewGetOldSym(globalView));
+        if(globalNetView == cirNetViewNull) {
+            globalNetView = netViewCreate(netlist, dbNetNull, cirGlobalViewGetOldSym(globalView),
+                globalView);
+        } else if(cirNetViewGetGlobal(globalNetView) != globalView) {
+            utError("Net %s in netlist %s is not attached to the global version",
+                cirNetViewGetName(globalNetView), dbNetlistGetName(netlist));
+        }
+        cirNetSetView(net, globalNetView);
+        cirNetViewDestroy(netView);
+    } else if(netGlobalView != globalView) {
+        utWarning("Net %s in netlist %s assigned to global nets %s and %s",
+            cirNetViewGetName(netView), dbNetlistGetName(netlist),
+            utSymGetName(cirGlobalViewGetOldSym(globalView)),
+            utSymGetName(cirGlobalViewGetOldSym(netGlobalView)));
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build an instance view.
+--------------------------------------------------------------------------------------------------*/
+static void instViewCreate(
+    dbNetlist netlist,
+    dbInst inst,
+    utSym sym,
+    bool exploded,
+    uint32 portPosition,
+    uint32 instWidth)
+{
+    cirInstView instView = cirInstViewAlloc();
+
+    cirInstViewSetInst(instView, inst);
+    cirInstViewSetSym(instView, sym);
+    cirInstViewSetExploded(instView, exploded);
+    cirInstViewSetPortPosition(instView, portPosition);
+    cirInstViewSetInstWidth(instView, instWidth);
+    cirNetlistAppendInstView(netlist, instView);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build views of the bits of an instance array, like dbInstExplode.
+--------------------------------------------------------------------------------------------------*/
+static void explodeInst(
+    dbNetlist netlist,
+    dbInst inst)
+{
+    uint32 left, right, instWidth;
+    bool isArray = dbNameHasRange(dbInstGetUserName(inst), &left, &right);
+    uint32 xInst = left;
+    uint32 portPosition = 0;
+    utSym name;
+
+    utAssert(isArray);
+    instWidth = utAbs((int32)right - (int32)left) + 1;
+    utDo {
+        name = dbFindArrayInstName(inst, xInst);
+        if(cirNetlistFindInstView(netlist, name) != cirInstViewNull) {
+            utExit("dbInstCreate: inst %s already defined", utSymGetName(name));
+        }
+        instViewCreate(netlist, inst, name, true, portPosition, instWidth);
+    } utWhile(xInst != right) {
+        if(xInst < right) {
+            xInst++;
+        } else {
+            xInst--;
+        }
+        portPosition++;
+    } utRepeat;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the instance is an array that would be exploded.
+--------------------------------------------------------------------------------------------------*/
+static bool isExplodedInst(
+    dbInst inst)
+{
+    return dbInstArray(inst) && dbInstGetType(inst) != DB_FLAG;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the netlist's instance views.  Power instances are converted to globals, and instance
+  arrays are exploded, with the bits going after the other instances.
+--------------------------------------------------------------------------------------------------*/
+static void buildInstViews(
+    dbNetlist netlist)
+{
+    dbInst inst;
+
+    dbForeachNetlistInst(netlist, inst) {
+        if(isPowerInst(inst)) {
+            convertPowerInst(netlist, inst);
+        }
+    } dbEndNetlistInst;
+    dbForeachNetlistInst(netlist, inst) {
+        if(!isPowerInst(inst) && !isExplodedInst(inst)) {
+            instViewCreate(netlist, inst, dbInstGetSym(inst), false, 0, 0);
+        }
+    } dbEndNetlistInst;
+    dbForeachNetlistInst(netlist, inst) {
+        if(!isPowerInst(inst) && isExplodedInst(inst)) {
+            explodeInst(netlist, inst);
+        }
+    } dbEndNetlistInst;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the netlist's mport views.
+--------------------------------------------------------------------------------------------------*/
+static void buildMportViews(
+    dbNetlist netlist)
+{
+    cirMportView mportView;
+    dbMport mport;
+
+    dbForeachNetlistMport(netlist, mport) {
+        mportView = cirMportViewAlloc();
+        cirMportViewSetMport(mportView, mport);
+        cirMportViewSetSym(mportView, dbMportGetSym(mport));
+        cirNetlistAppendMportView(netlist, mportView);
+        cirMportSetView(mport, mportView);
+    } dbEndNetlistMport;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Munge names in the netlist's views, like dbNetlistEliminateNonAlnumChars.
+--------------------------------------------------------------------------------------------------*/
+static void mungeNetlistViewNames(
+    dbNetlist netlist)
+{
+    cirInstView instView;
+    cirNetView netView;
+    cirMportView mportView;
+    char *newName;
+
+    cirForeachNetlistInstView(netlist, instView) {
+        if(dbInstGetType(cirInstViewGetInst(instView)) != DB_FLAG) {
+            newName = dbMungeName(cirInstViewGetName(instView));
+            cirNetlistRenameInstView(netlist, instView, utSymNull);
+            cirNetlistRenameInstView(netlist, instView, createUniqueInstName(netlist, newName));
+        }
+    } cirEndNetlistInstView;
+    cirForeachNetlistNetView(netlist, netView) {
+        newName = dbMungeName(cirNetViewGetName(netView));
+        cirNetlistRenameNetView(netlist, netView, utSymNull);
+        cirNetlistRenameNetView(netlist, netView, createUniqueNetName(netlist, newName, true));
+    } cirEndNetlistNetView;
+    cirForeachNetlistMportView(netlist, mportView) {
+        newName = dbMungeName(cirMportViewGetName(mportView));
+        cirNetlistRenameMportView(netlist, mportView, utSymNull);
+        cirNetlistRenameMportView(netlist, mportView, createUniqueMportName(netlist, newName));
+    } cirEndNetlistMportView;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the views of a netlist in the viewed design, if not already built.
+--------------------------------------------------------------------------------------------------*/
+void cirViewNetlist(
+    dbNetlist netlist)
+{
+    if(cirNetlistViewed(netlist) || dbNetlistGetDesign(netlist) != cirViewDesign) {
+        return;
+    }
+    cirNetlistSetViewed(netlist, true);
+    buildNetViews(netlist);
+    buildInstViews(netlist);
+    buildMportViews(netlist);
+    if(dbNetlistGetType(netlist) != DB_DEVICE) {
+        mungeNetlistViewNames(netlist);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the name a net is written with.
+--------------------------------------------------------------------------------------------------*/
+char *cirViewGetNetName(
+    dbNet net)
+{
+    cirNetView netView = cirNetGetView(net);
+    cirGlobalView globalView;
+    dbGlobal global;
+
+    if(netView == cirNetViewNull) {
+        global = dbNetGetGlobal(net);
+        if(global == dbGlobalNull) {
+            return dbNetGetName(net);
+        }
+        globalView = cirGlobalGetView(global);
+        if(globalView == cirGlobalViewNull) {
+            return dbGlobalGetName(global);
+        }
+        return cirGlobalViewGetName(globalView);
+    }
+    globalView = cirNetViewGetGlobal(netView);
+    if(globalView != cirGlobalViewNull) {
+        return cirGlobalViewGetName(globalView);
+    }
+    return cirNetViewGetName(netView);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the name a netlist is written with.  Netlists of other designs, such as libraries, keep
+  their names.
+--------------------------------------------------------------------------------------------------*/
+char *cirViewGetNetlistName(
+    dbNetlist netlist)
+{
+    cirNetlistView netlistView = cirNetlistGetView(netlist);
+
+    if(netlistView == cirNetlistViewNull) {
+        return dbNetlistGetName(netlist);
+    }
+    return cirNetlistViewGetName(netlistView);
+}
@@ -34,6 +34,43 @@ static char *cirLine;
 static uint32 cirLinePos, cirLineSize, cirLastBreakPos;
 static bool cirInComment;
 static uint32 cirMaxLineLength;
+static char *cirOutput; /* Finished lines waiting to be written */
+static uint32 cirOutputPos;
+
+#define CIR_OUTPUT_SIZE (1 << 20)
+
+/* When preserving the design, names and instances come from views of it */
+static bool cirPreserveDesign;
+static cirInstView cirCurrentInstView;
+static dbPort *cirBitPorts; /* Ports of the array instance that the current bit connects to */
+static dbMport *cirBitMports;
+static uint32 cirNumBitPorts, cirMaxBitPorts;
+
+/* When writing flat, the hierarchy is walked depth first, keeping one level per instance on the
+   way down.  A level holds the flat names of the nets on its netlist's mports, and the values of
+   its netlist's parameters. */
+typedef struct cirFlatLevelStruct *cirFlatLevel;
+struct cirFlatLevelStruct {
+    dbNetlist netlist;
+    uint32 prefixLength; /* Length of the instance path in cirFlatPrefix */
+    uint32 *mportNets; /* Offsets into names of the flat nets, by mport position */
+    uint32 numMports, maxMports;
+    utSym *params;
+    uint32 *paramValues; /* Offsets into names of the parameter values */
+    uint32 numParams, maxParams;
+    char *names; /* Net names and parameter values */
+    uint32 namesLength, maxNamesLength;
+};
+
+#define CIR_NO_NET UINT32_MAX
+
+static bool cirFlatSpice;
+static cirFlatLevel cirFlatLevels;
+static uint32 cirFlatDepth, cirMaxFlatDepth; /* cirFlatDepth is 0 unless writing flat */
+static char *cirFlatPrefix; /* Path of instances down to the current level */
+static uint32 cirFlatPrefixSize;
+static char *cirFlatValue; /* Attribute value with parameters replaced */
+static uint32 cirFlatValueSize;
 
 utSym cirGraphicalSym, cirNetSym, cirSpiceTypeSym, cirSpiceTextSym;
 
@@ -47,20 +84,104 @@ dbSpiceTargetType cirTarget;
 bool cirUseBracesAroundParams, cirDeclareParameters;
 char cirHierarchySeparator;
 
+/*--------------------------------------------------------------------------------------------------
+  Get the flat name of a net in the current level.  Nets on mports take the names found for them
+  in the level above, so aliases resolve to the name of the net at the top of the connection.
+--------------------------------------------------------------------------------------------------*/
+static char *getFlatNetName(
+    dbNet net)
+{
+    cirFlatLevel level = cirFlatLevels + cirFlatDepth - 1;
+    dbGlobal global = dbNetGetGlobal(net);
+    dbMport mport;
+    uint32 offset;
+
+    if(global != dbGlobalNull) {
+        return dbGlobalGetName(global);
+    }
+    if(cirFlatDepth == 1) {
+        return dbNetGetName(net);
+    }
+    mport = cirNetGetFlatMport(net);
+    if(mport != dbMportNull) {
+        offset = level->mportNets[dbMportGetPosition(mport)];
+        if(offset != CIR_NO_NET) {
+            return level->names + offset;
+        }
+    }
+    return utSprintf("%s%c%s", cirFlatPrefix, cirHierarchySeparator, dbNetGetName(net));
+}
+
 /*--------------------------------------------------------------------------------------------------
   Get the name of the net, or it's global if it exists.
 --------------------------------------------------------------------------------------------------*/
 static char *getNetName(
     dbNet net)
 {
-    dbGlobal global = dbNetGetGlobal(net);
+    dbGlobal global;
 
+    if(cirFlatDepth > 0) {
+        return getFlatNetName(net);
+    }
+    if(cirPreserveDesign) {
+        return cirViewGetNetName(net);
+    }
+    global = dbNetGetGlobal(net);
     if(global != dbGlobalNull) {
         return dbGlobalGetName(global);
     }
     return dbNetGetName(net);
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Get the name of the netlist.
+--------------------------------------------------------------------------------------------------*/
+static char *getNetlistName(
+    dbNetlist netlist)
+{
+    if(cirPreserveDesign) {
+        return cirViewGetNetlistName(netlist);
+    }
+    return dbNetlistGetName(netlist);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Get the name of the instance being written.
+--------------------------------------------------------------------------------------------------*/
+static char *getInstName(
+    dbInst inst)
+{
+    if(cirFlatDepth > 1) {
+        return utSprintf("%s%c%s", cirFlatPrefix, cirHierarchySeparator, dbInstGetUserName(inst));
+    }
+    if(cirPreserveDesign && cirCurrentInstView != cirInstViewNull) {
+        return cirInstViewGetName(cirCurrentInstView);
+    }
+    return dbInstGetUserName(inst);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Get the name of the device being written.  Below the top, flat names start with the first letter
+  of the device's own name, since SPICE finds the device type from it.
+--------------------------------------------------------------------------------------------------*/
+static char *getDeviceName(
+    dbInst inst)
+{
+    if(cirFlatDepth > 1) {
+        return utSprintf("%c%s", *dbInstGetUserName(inst), getInstName(inst));
+    }
+    return getInstName(inst);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the instance being written is one bit of an instance array.
+--------------------------------------------------------------------------------------------------*/
+static bool writingInstBit(void)
+{
+    return cirPreserveDesign && cirCurrentInstView != cirInstViewNull &&
+        cirInstViewExploded(cirCurrentInstView);
+}
+
 /*--------------------------------------------------------------------------------------------------
   Build devices from the definition file or string.
 --------------------------------------------------------------------------------------------------*/
@@ -184,6 +305,35 @@ static void extendNetlists(
     }
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Write the finished lines to cirFile.
+--------------------------------------------------------------------------------------------------*/
+static void flushOutput(void)
+{
+    if(cirOutputPos > 0) {
+        fwrite(cirOutput, 1, cirOutputPos, cirFile);
+        cirOutputPos = 0;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add text to the finished lines.
+--------------------------------------------------------------------------------------------------*/
+static void emit(
+    char *text,
+    uint32 length)
+{
+    if(cirOutputPos + length > CIR_OUTPUT_SIZE) {
+        flushOutput();
+        if(length > CIR_OUTPUT_SIZE) {
+            fwrite(text, 1, length, cirFile);
+            return;
+        }
+    }
+    memcpy(cirOutput + cirOutputPos, text, length);
+    cirOutputPos += length;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Print any remaining characters that are in the buffer.
 --------------------------------------------------------------------------------------------------*/
@@ -195,14 +345,16 @@ static void flushBuffer(void)
             utResizeArray(cirLine, cirLineSize);
         }
         cirLine[cirLinePos] = '\0';
-        fprintf(cirFile, "%s", cirLine);
+        emit(cirLine, cirLinePos);
         cirLinePos = 0;
     }
+    flushOutput();
 }
 
 /*--------------------------------------------------------------------------------------------------
   Add a character to the current line buffer.  If we reach a newline, print the line, or break
-  the line if it is too long.
+  the line if it is too long.  A line is only broken at a space written since the line, or its
+  last continuation, started.  Text with no such space is left long.
 --------------------------------------------------------------------------------------------------*/
 static void addChar(
     char c)
@@ -222,16 +374,17 @@ static void addChar(
     }
     cirLine[cirLinePos++] = c;
     if(c == '\n') {
-        cirLine[cirLinePos] = '\0';
-        fprintf(cirFile, "%s", cirLine);
+        emit(cirLine, cirLinePos);
         cirLinePos = 0;
+        cirLastBreakPos = UINT32_MAX;
     } else {
         if(c == ' ') {
             cirLastBreakPos = cirLinePos - 1;
         }
         if(cirLastBreakPos != UINT32_MAX && cirLinePos >= cirMaxLineLength) {
-            cirLine[cirLastBreakPos++] = '\0';
-            fprintf(cirFile, "%s\n", cirLine);
+            emit(cirLine, cirLastBreakPos);
+            emit("\n", 1);
+            cirLastBreakPos++;
             linePos = 0;
             if(cirInComment) {
                 cirLine[linePos++] = '*';
@@ -242,6 +395,45 @@ static void addChar(
                 cirLine[linePos++] = cirLine[cirLastBreakPos++];
             }
             cirLinePos = linePos;
+            cirLastBreakPos = UINT32_MAX;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a string to the current line buffer.  Spaces, newlines, and the first character on a line
+  go through addChar, but runs of other characters are copied in one go, up to the point where
+  the line could need breaking.
+--------------------------------------------------------------------------------------------------*/
+static void addString(
+    char *string)
+{
+    uint32 length, maxLength;
+
+    while(*string != '\0') {
+        length = 0;
+        if(cirLinePos != 0) {
+            length = strcspn(string, " \n");
+            if(cirLastBreakPos != UINT32_MAX) {
+                maxLength = cirMaxLineLength > cirLinePos + 1?
+                    cirMaxLineLength - cirLinePos - 1 : 0;
+                if(length > maxLength) {
+                    length = maxLength;
+                }
+            }
+        }
+        if(length == 0) {
+            addChar(*string++);
+        } else {
+            if(cirLinePos + length + 2 >= cirLineSize) {
+                do {
+                    cirLineSize <<= 1;
+                } while(cirLinePos + length + 2 >= cirLineSize);
+                utResizeArray(cirLine, cirLineSize);
+            }
+            memcpy(cirLine + cirLinePos, string, length);
+            cirLinePos += length;
+            string += length;
         }
     }
 }
@@ -259,10 +451,17 @@ void cirPrint(
     va_start(ap, format);
     line = utVsprintf(format, ap);
     va_end(ap);
-    while(*line != '\0') {
-        addChar(*line);
-        line++;
-    }
+    addString(line);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write a space and then the name.  This is the same as cirPrint(" %s", name), without formatting.
+--------------------------------------------------------------------------------------------------*/
+static void printName(
+    char *name)
+{
+    addChar(' ');
+    addString(name);
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -271,11 +470,18 @@ void cirPrint(
 static void writeGlobals(
     dbDesign design)
 {
+    cirGlobalView globalView;
     dbGlobal global;
 
-    dbForeachDesignGlobal(design, global) {
-        cirPrint(".global %s\n", dbGlobalGetName(global));
-    } dbEndDesignGlobal;
+    if(cirPreserveDesign) {
+        cirForeachRootGlobalView(cirTheRoot, globalView) {
+            cirPrint(".global %s\n", cirGlobalViewGetName(globalView));
+        } cirEndRootGlobalView;
+    } else {
+        dbForeachDesignGlobal(design, global) {
+            cirPrint(".global %s\n", dbGlobalGetName(global));
+        } dbEndDesignGlobal;
+    }
     cirPrint("\n");
 }
 
@@ -285,13 +491,89 @@ static void writeGlobals(
 static void writeMports(
     dbNetlist netlist)
 {
+    cirMportView mportView;
     dbMport mport;
 
+    if(cirNetlistViewed(netlist)) {
+        cirForeachNetlistMportView(netlist, mportView) {
+            printName(cirMportViewGetName(mportView));
+        } cirEndNetlistMportView;
+        return;
+    }
     dbForeachNetlistMport(netlist, mport) {
-        cirPrint(" %s", dbMportGetName(mport));
+        printName(dbMportGetName(mport));
     } dbEndNetlistMport;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Add text to cirFlatValue at the position, and return the position after it.
+--------------------------------------------------------------------------------------------------*/
+static uint32 addFlatValueText(
+    uint32 pos,
+    char *text,
+    uint32 length)
+{
+    if(pos + length + 1 > cirFlatValueSize) {
+        cirFlatValueSize = pos + length + 1 + ((pos + length + 1) >> 1);
+        if(cirFlatValue == NULL) {
+            cirFlatValue = utNewA(char, cirFlatValueSize);
+        } else {
+            utResizeArray(cirFlatValue, cirFlatValueSize);
+        }
+    }
+    memcpy(cirFlatValue + pos, text, length);
+    cirFlatValue[pos + length] = '\0';
+    return pos + length;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the value of the parameter in the current flat level, or NULL if it is not one of the level's
+  parameters.
+--------------------------------------------------------------------------------------------------*/
+static char *findFlatParamValue(
+    char *name,
+    uint32 length)
+{
+    cirFlatLevel level = cirFlatLevels + cirFlatDepth - 1;
+    char *paramName;
+    uint32 xParam;
+
+    for(xParam = 0; xParam < level->numParams; xParam++) {
+        paramName = utSymGetName(level->params[xParam]);
+        if(!strncmp(paramName, name, length) && paramName[length] == '\0') {
+            return level->names + level->paramValues[xParam];
+        }
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Replace each {IDENT} parameter of the current flat level in the value with the parameter's value,
+  as the sub-circuit instance above passes it.  At the top there is nothing to replace.
+--------------------------------------------------------------------------------------------------*/
+static char *substituteFlatParams(
+    char *value)
+{
+    char *start, *end, *paramValue;
+    uint32 pos = 0;
+
+    if(cirFlatDepth <= 1 || strchr(value, '{') == NULL) {
+        return value;
+    }
+    while((start = strchr(value, '{')) != NULL && (end = strchr(start, '}')) != NULL) {
+        paramValue = findFlatParamValue(start + 1, end - start - 1);
+        if(paramValue != NULL) {
+            pos = addFlatValueText(pos, value, start - value);
+            pos = addFlatValueText(pos, paramValue, strlen(paramValue));
+        } else {
+            pos = addFlatValueText(pos, value, end + 1 - value);
+        }
+        value = end + 1;
+    }
+    pos = addFlatValueText(pos, value, strlen(value));
+    return utCopyString(cirFlatValue);
+}
+
 /*--------------------------------------------------------------------------------------------------
   If needed, strip out the braces from the string.
 --------------------------------------------------------------------------------------------------*/
@@ -300,6 +582,7 @@ static char *preProcessValue(
 {
     char *string, c, *prev, *next;
 
+    value = substituteFlatParams(value);
     if(cirUseBracesAroundParams) {
         return value;
     }
@@ -349,13 +632,20 @@ static void writeSubcircuitInst(
     dbNetlist internalNetlist = dbInstGetInternalNetlist(inst);
     dbNet net;
     dbPort port;
+    uint32 xPort;
 
-    cirPrint("X%s", dbInstGetUserName(inst));
-    dbForeachInstPort(inst, port) {
-        net = dbPortGetNet(port);
-        cirPrint(" %s", getNetName(net));
-    } dbEndInstPort;
-    cirPrint(" %s", dbNetlistGetName(internalNetlist));
+    cirPrint("X%s", getInstName(inst));
+    if(writingInstBit()) {
+        for(xPort = 0; xPort < cirNumBitPorts; xPort++) {
+            printName(getNetName(dbPortGetNet(cirBitPorts[xPort])));
+        }
+    } else {
+        dbForeachInstPort(inst, port) {
+            net = dbPortGetNet(port);
+            printName(getNetName(net));
+        } dbEndInstPort;
+    }
+    printName(getNetlistName(internalNetlist));
     writeSubcircuitParameters(inst);
     cirPrint("\n");
 }
@@ -379,7 +669,7 @@ static void writeDeviceAttr(
             return;
         }
         utWarning("Instance %s in netlist %s is missing manditory attribute %s",
-            dbInstGetUserName(inst), dbNetlistGetName(dbInstGetNetlist(inst)), cirAttrGetName(attr));
+            getInstName(inst), getNetlistName(dbInstGetNetlist(inst)), cirAttrGetName(attr));
         cirPrint(" <missing_%s>", cirAttrGetName(attr));
     } else {
         value = dbAttrGetValue(dbattr);
@@ -389,8 +679,8 @@ static void writeDeviceAttr(
             } else {
                 if(value == utSymNull) {
                     utWarning("Value expected for attribute %s on instance %s in netlist %s",
-                        cirAttrGetName(attr), dbInstGetUserName(inst),
-                        dbNetlistGetName(dbInstGetNetlist(inst)));
+                        cirAttrGetName(attr), getInstName(inst),
+                        getNetlistName(dbInstGetNetlist(inst)));
                 } else {
                     cirPrint(" %s=%s", cirAttrGetName(attr), preProcessValue(utSymGetName(value)));
                 }
@@ -398,8 +688,8 @@ static void writeDeviceAttr(
         } else {
             if(value == utSymNull) {
                 utWarning("Value expected for attribute %s on instance %s in netlist %s",
-                    cirAttrGetName(attr), dbInstGetUserName(inst),
-                    dbNetlistGetName(dbInstGetNetlist(inst)));
+                    cirAttrGetName(attr), getInstName(inst),
+                    getNetlistName(dbInstGetNetlist(inst)));
             } else {
                 cirPrint(" %s", preProcessValue(utSymGetName(value)));
             }
@@ -484,6 +774,27 @@ static char *findDefaultNetForPin(
     return NULL;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Find the instance's port on the mport.  A bit of an instance array uses the first of the array's
+  ports it connects to on the mport, just like the instance dbInstExplode would build.
+--------------------------------------------------------------------------------------------------*/
+static dbPort findInstPort(
+    dbInst inst,
+    dbMport mport)
+{
+    uint32 xPort;
+
+    if(!writingInstBit()) {
+        return dbFindPortFromInstMport(inst, mport);
+    }
+    for(xPort = 0; xPort < cirNumBitPorts; xPort++) {
+        if(cirBitMports[xPort] == mport) {
+            return cirBitPorts[xPort];
+        }
+    }
+    return dbPortNull;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Write the device instance's pin connection.
 --------------------------------------------------------------------------------------------------*/
@@ -494,26 +805,26 @@ static void writePin(
     dbNetlist internalNetlist = dbInstGetInternalNetlist(inst);
     dbNet net;
     dbMport mport = dbNetlistFindMport(internalNetlist, cirPinGetSym(pin));
-    dbPort port = dbFindPortFromInstMport(inst, mport);
+    dbPort port = findInstPort(inst, mport);
     char *pinName = cirPinGetName(pin);
     char *netName;
 
     if(port == dbPortNull) {
         netName = findDefaultNetForPin(inst, pinName);
         if(netName == NULL) {
-            utWarning("Inst %s has no %s port... grounding", dbInstGetUserName(inst), pinName);
+            utWarning("Inst %s has no %s port... grounding", getInstName(inst), pinName);
             cirPrint(" 0", pinName);
         } else {
-            cirPrint(" %s", netName);
+            printName(netName);
         }
     } else {
         net = dbPortGetNet(port);
         if(net == dbNetNull) {
-            utWarning("Port %s in netlist %s has no net", dbPortGetName(port),
-                dbNetlistGetName(dbInstGetNetlist(inst)));
+            utWarning("Port %s.%s in netlist %s has no net", getInstName(inst),
+                dbMportGetName(dbPortGetMport(port)), getNetlistName(dbInstGetNetlist(inst)));
             cirPrint(" <unconnected>");
         } else {
-            cirPrint(" %s", getNetName(net));
+            printName(getNetName(net));
         }
     }
 }
@@ -530,7 +841,7 @@ static bool writeDeviceInst(
     cirPin pin;
     dbAttr deviceAttrs = dbNetlistGetAttr(internalNetlist);
     utSym deviceType = dbFindAttrValue(deviceAttrs, cirSpiceTypeSym);
-    char *instName = dbInstGetUserName(inst);
+    char *instName = getDeviceName(inst);
  
     if(dbFindAttrNoCase(deviceAttrs, cirGraphicalSym) != dbAttrNull) {
         return true; /* This is just a graphical thing */
@@ -575,7 +886,7 @@ static void writeInst(
         break;
     case DB_POWER:
         utWarning("Power instance %s should have been converted to a global net",
-            dbInstGetUserName(inst));
+            getInstName(inst));
         break;
     case DB_FLAG:
         break;
@@ -584,17 +895,59 @@ static void writeInst(
     }
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Find the ports of the instance array that a bit of it connects to.
+--------------------------------------------------------------------------------------------------*/
+static void findBitPorts(
+    dbInst arrayInst,
+    uint32 portPosition,
+    uint32 instWidth)
+{
+    dbPort port;
+    uint32 numPorts = 0;
+
+    dbForeachInstPort(arrayInst, port) {
+        numPorts++;
+    } dbEndInstPort;
+    if(numPorts > cirMaxBitPorts) {
+        cirMaxBitPorts = numPorts + (numPorts >> 1);
+        if(cirBitPorts == NULL) {
+            cirBitPorts = utNewA(dbPort, cirMaxBitPorts);
+            cirBitMports = utNewA(dbMport, cirMaxBitPorts);
+        } else {
+            utResizeArray(cirBitPorts, cirMaxBitPorts);
+            utResizeArray(cirBitMports, cirMaxBitPorts);
+        }
+    }
+    cirNumBitPorts = dbFindArrayInstBitPorts(arrayInst, portPosition, instWidth, cirBitPorts,
+        cirBitMports);
+}
+
 /*--------------------------------------------------------------------------------------------------
   Write out the netlist's instances.
 --------------------------------------------------------------------------------------------------*/
 static void writeInsts(
     dbNetlist netlist)
 {
+    cirInstView instView;
     dbInst inst;
 
-    dbForeachNetlistInst(netlist, inst) {
+    if(!cirNetlistViewed(netlist)) {
+        dbForeachNetlistInst(netlist, inst) {
+            writeInst(inst);
+        } dbEndNetlistInst;
+        return;
+    }
+    cirForeachNetlistInstView(netlist, instView) {
+        cirCurrentInstView = instView;
+        inst = cirInstViewGetInst(instView);
+        if(cirInstViewExploded(instView)) {
+            findBitPorts(inst, cirInstViewGetPortPosition(instView),
+                cirInstViewGetInstWidth(instView));
+        }
         writeInst(inst);
-    } dbEndNetlistInst;
+    } cirEndNetlistInstView;
+    cirCurrentInstView = cirInstViewNull;
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -651,8 +1004,11 @@ static void writeNetlist(
     }
     design = dbNetlistGetDesign(netlist);
     isRoot = dbDesignGetRootNetlist(design) == netlist;
+    if(cirPreserveDesign) {
+        cirViewNetlist(netlist);
+    }
     if(!isRoot || cirIncludeTopLevelPorts) {
-        cirPrint(".subckt %s", dbNetlistGetName(netlist));
+        cirPrint(".subckt %s", getNetlistName(netlist));
         writeMports(netlist);
         if(cirDeclareParameters) {
             writeParameterDeclarations(netlist);
@@ -667,21 +1023,40 @@ static void writeNetlist(
 }
 
 /*--------------------------------------------------------------------------------------------------
-  Write the child netlists of netlist so that they get declared first.
+  Write the child netlists of netlist so that they get declared first.  Unless writing the whole
+  library, only netlists of the netlist's own design are written.  Children are visited in the
+  order their instances are written, so preserving the design does not change the order.
 --------------------------------------------------------------------------------------------------*/
 static void writeNetlistAndChildren(
-    dbNetlist netlist)
+    dbNetlist netlist,
+    bool wholeLibrary)
 {
+    dbDesign design = dbNetlistGetDesign(netlist);
     dbNetlist internalNetlist;
+    cirInstView instView;
     dbInst inst;
 
     dbNetlistSetVisited(netlist, true);
-    dbForeachNetlistInst(netlist, inst) {
-        internalNetlist = dbInstGetInternalNetlist(inst);
-        if(!dbNetlistVisited(internalNetlist)) {
-            writeNetlistAndChildren(internalNetlist);
-        }
-    } dbEndNetlistInst;
+    if(cirPreserveDesign) {
+        cirViewNetlist(netlist);
+    }
+    if(cirNetlistViewed(netlist)) {
+        cirForeachNetlistInstView(netlist, instView) {
+            internalNetlist = dbInstGetInternalNetlist(cirInstViewGetInst(instView));
+            if(!dbNetlistVisited(internalNetlist) &&
+                    (wholeLibrary || dbNetlistGetDesign(internalNetlist) == design)) {
+                writeNetlistAndChildren(internalNetlist, wholeLibrary);
+            }
+        } cirEndNetlistInstView;
+    } else {
+        dbForeachNetlistInst(netlist, inst) {
+            internalNetlist = dbInstGetInternalNetlist(inst);
+            if(!dbNetlistVisited(internalNetlist) &&
+                    (wholeLibrary || dbNetlistGetDesign(internalNetlist) == design)) {
+                writeNetlistAndChildren(internalNetlist, wholeLibrary);
+            }
+        } dbEndNetlistInst;
+    }
     writeNetlist(netlist);
 }
 
@@ -694,15 +1069,15 @@ static void writeNetlists(
 {
     dbNetlist netlist;
 
+    dbDesignClearNetlistVisitedFlags(design);
     if(wholeLibrary) {
-        dbDesignClearNetlistVisitedFlags(design);
         dbForeachDesignNetlist(design, netlist) {
             if(!dbNetlistVisited(netlist)) {
-                writeNetlistAndChildren(netlist);
+                writeNetlistAndChildren(netlist, true);
             }
         } dbEndDesignNetlist;
     } else {
-        dbDesignVisitNetlists(design, writeNetlist);
+        writeNetlistAndChildren(dbDesignGetRootNetlist(design), false);
     }
 }
 
@@ -722,6 +1097,311 @@ static void writeDesign(
     }
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Make room for one more level of hierarchy.
+--------------------------------------------------------------------------------------------------*/
+static cirFlatLevel growFlatLevels(void)
+{
+    uint32 oldMaxDepth = cirMaxFlatDepth;
+
+    if(cirFlatDepth == cirMaxFlatDepth) {
+        cirMaxFlatDepth = cirMaxFlatDepth == 0? 16 : cirMaxFlatDepth << 1;
+        if(cirFlatLevels == NULL) {
+            cirFlatLevels = utNewA(struct cirFlatLevelStruct, cirMaxFlatDepth);
+        } else {
+            utResizeArray(cirFlatLevels, cirMaxFlatDepth);
+        }
+        memset(cirFlatLevels + oldMaxDepth, 0,
+            (cirMaxFlatDepth - oldMaxDepth)*sizeof(struct cirFlatLevelStruct));
+    }
+    return cirFlatLevels + cirFlatDepth;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Make cirFlatPrefix hold the path.
+--------------------------------------------------------------------------------------------------*/
+static void setFlatPrefix(
+    char *path,
+    uint32 length)
+{
+    if(length + 1 > cirFlatPrefixSize) {
+        cirFlatPrefixSize = length + 1 + ((length + 1) >> 1);
+        if(cirFlatPrefix == NULL) {
+            cirFlatPrefix = utNewA(char, cirFlatPrefixSize);
+        } else {
+            utResizeArray(cirFlatPrefix, cirFlatPrefixSize);
+        }
+    }
+    memmove(cirFlatPrefix, path, length);
+    cirFlatPrefix[length] = '\0';
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Record the flat name of the net on the mport in the level.
+--------------------------------------------------------------------------------------------------*/
+static void setFlatMportNet(
+    cirFlatLevel level,
+    uint32 position,
+    char *name)
+{
+    uint32 length = strlen(name) + 1;
+
+    if(level->namesLength + length > level->maxNamesLength) {
+        level->maxNamesLength = level->namesLength + length + ((level->namesLength + length) >> 1);
+        if(level->names == NULL) {
+            level->names = utNewA(char, level->maxNamesLength);
+        } else {
+            utResizeArray(level->names, level->maxNamesLength);
+        }
+    }
+    memcpy(level->names + level->namesLength, name, length);
+    level->mportNets[position] = level->namesLength;
+    level->namesLength += length;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Record the value of the netlist's parameter in the level.
+--------------------------------------------------------------------------------------------------*/
+static void setFlatParam(
+    cirFlatLevel level,
+    utSym name,
+    char *value)
+{
+    uint32 length = strlen(value) + 1;
+
+    if(level->numParams == level->maxParams) {
+        level->maxParams = level->maxParams == 0? 8 : level->maxParams << 1;
+        if(level->params == NULL) {
+            level->params = utNewA(utSym, level->maxParams);
+            level->paramValues = utNewA(uint32, level->maxParams);
+        } else {
+            utResizeArray(level->params, level->maxParams);
+            utResizeArray(level->paramValues, level->maxParams);
+        }
+    }
+    if(level->namesLength + length > level->maxNamesLength) {
+        level->maxNamesLength = level->namesLength + length + ((level->namesLength + length) >> 1);
+        if(level->names == NULL) {
+            level->names = utNewA(char, level->maxNamesLength);
+        } else {
+            utResizeArray(level->names, level->maxNamesLength);
+        }
+    }
+    memcpy(level->names + level->namesLength, value, length);
+    level->params[level->numParams] = name;
+    level->paramValues[level->numParams++] = level->namesLength;
+    level->namesLength += length;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Go down a level into the instance.  The flat names of the nets on its ports, and the values of
+  its parameters, are found while the level above is still current.  Parameters take the value
+  the instance passes, or else the netlist's default, just as writeSubcircuitParameters writes
+  them, and 0 if there is neither, as in the parameter declarations.  Each net on an mport of the
+  netlist is marked with the first such mport, so getFlatNetName finds it without searching.
+--------------------------------------------------------------------------------------------------*/
+static void pushFlatLevel(
+    dbInst inst)
+{
+    dbNetlist internalNetlist = dbInstGetInternalNetlist(inst);
+    cirFlatLevel level = growFlatLevels();
+    uint32 numMports = dbNetlistGetNextMportPosition(internalNetlist);
+    uint32 position, xMport;
+    cirParam param;
+    dbMport mport;
+    dbPort port;
+    dbNet net;
+    utSym name, value;
+    char *path;
+
+    if(numMports > level->maxMports) {
+        level->maxMports = numMports + (numMports >> 1);
+        if(level->mportNets == NULL) {
+            level->mportNets = utNewA(uint32, level->maxMports);
+        } else {
+            utResizeArray(level->mportNets, level->maxMports);
+        }
+    }
+    for(xMport = 0; xMport < numMports; xMport++) {
+        level->mportNets[xMport] = CIR_NO_NET;
+    }
+    level->numMports = numMports;
+    level->namesLength = 0;
+    dbForeachNetlistMport(internalNetlist, mport) {
+        port = dbMportGetFlagPort(mport);
+        if(port != dbPortNull) {
+            net = dbPortGetNet(port);
+            if(net != dbNetNull && cirNetGetFlatMport(net) == dbMportNull) {
+                cirNetSetFlatMport(net, mport);
+            }
+        }
+    } dbEndNetlistMport;
+    dbForeachInstPort(inst, port) {
+        net = dbPortGetNet(port);
+        position = dbMportGetPosition(dbPortGetMport(port));
+        if(net != dbNetNull && level->mportNets[position] == CIR_NO_NET) {
+            setFlatMportNet(level, position, getNetName(net));
+        }
+    } dbEndInstPort;
+    level->numParams = 0;
+    cirForeachNetlistParam(internalNetlist, param) {
+        name = cirParamGetSym(param);
+        value = dbFindAttrValue(dbInstGetAttr(inst), name);
+        if(value == utSymNull) {
+            value = dbFindAttrValue(dbNetlistGetAttr(internalNetlist), name);
+        }
+        if(value == utSymNull) {
+            setFlatParam(level, name, "0");
+        } else {
+            setFlatParam(level, name, substituteFlatParams(utSymGetName(value)));
+        }
+    } cirEndNetlistParam;
+    path = getInstName(inst);
+    level->prefixLength = strlen(path);
+    setFlatPrefix(path, level->prefixLength);
+    cirFlatDepth++;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Go back up a level.
+--------------------------------------------------------------------------------------------------*/
+static void popFlatLevel(void)
+{
+    cirFlatDepth--;
+    cirFlatPrefix[cirFlatLevels[cirFlatDepth - 1].prefixLength] = '\0';
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Determine if the sub-circuit has nothing in it to flatten, as with black boxes.
+--------------------------------------------------------------------------------------------------*/
+static bool netlistIsEmpty(
+    dbNetlist netlist)
+{
+    dbInst inst;
+
+    dbForeachNetlistInst(netlist, inst) {
+        if(dbInstGetType(inst) != DB_FLAG) {
+            return false;
+        }
+    } dbEndNetlistInst;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write the devices of the netlist at the current level, and those below them, depth first.
+--------------------------------------------------------------------------------------------------*/
+static void writeFlatNetlist(
+    dbNetlist netlist)
+{
+    dbNetlist internalNetlist;
+    dbInst inst;
+    uint32 xLevel;
+
+    cirFlatLevels[cirFlatDepth - 1].netlist = netlist;
+    dbForeachNetlistInst(netlist, inst) {
+        internalNetlist = dbInstGetInternalNetlist(inst);
+        if(dbNetlistGetType(internalNetlist) != DB_SUBCIRCUIT || netlistIsEmpty(internalNetlist)) {
+            writeInst(inst);
+        } else {
+            for(xLevel = 0; xLevel < cirFlatDepth; xLevel++) {
+                if(cirFlatLevels[xLevel].netlist == internalNetlist) {
+                    utError("Netlist %s instantiates itself", dbNetlistGetName(internalNetlist));
+                }
+            }
+            pushFlatLevel(inst);
+            writeFlatNetlist(internalNetlist);
+            popFlatLevel();
+        }
+    } dbEndNetlistInst;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write out a spice design flat, one line per device.  Each line is written as its device is
+  reached, so memory only grows with the depth of the hierarchy.  Sub-circuits with no instances,
+  such as black boxes, are written as instances, but not defined.
+--------------------------------------------------------------------------------------------------*/
+static void writeFlatDesign(
+    dbDesign design,
+    bool includeTopLevelPorts)
+{
+    dbNetlist rootNetlist = dbDesignGetRootNetlist(design);
+
+    cirIncludeTopLevelPorts = includeTopLevelPorts;
+    writeGlobals(design);
+    if(rootNetlist == dbNetlistNull) {
+        utWarning("Design %s has no root netlist", dbDesignGetName(design));
+        return;
+    }
+    if(includeTopLevelPorts) {
+        cirPrint(".subckt %s", getNetlistName(rootNetlist));
+        writeMports(rootNetlist);
+        if(cirDeclareParameters) {
+            writeParameterDeclarations(rootNetlist);
+        }
+        cirPrint("\n");
+    }
+    growFlatLevels();
+    setFlatPrefix("", 0);
+    cirFlatLevels[0].prefixLength = 0;
+    cirFlatDepth = 1;
+    writeFlatNetlist(rootNetlist);
+    cirFlatDepth = 0;
+    writeSpiceText(rootNetlist);
+    if(includeTopLevelPorts) {
+        cirPrint(".ends\n\n");
+    } else {
+        cirPrint(".end\n");
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find a name for a copy of the design that is not yet taken.
+--------------------------------------------------------------------------------------------------*/
+static utSym findCopyName(
+    dbDesign design)
+{
+    utSym name = utSymCreateFormatted("%s_flat", dbDesignGetName(design));
+    uint32 xCopy = 1;
+
+    while(dbRootFindDesign(dbTheRoot, name) != dbDesignNull) {
+        name = utSymCreateFormatted("%s_flat%u", dbDesignGetName(design), xCopy);
+        xCopy++;
+    }
+    return name;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Free the levels used for writing flat.
+--------------------------------------------------------------------------------------------------*/
+static void freeFlatLevels(void)
+{
+    cirFlatLevel level;
+    uint32 xLevel;
+
+    for(xLevel = 0; xLevel < cirMaxFlatDepth; xLevel++) {
+        level = cirFlatLevels + xLevel;
+        if(level->mportNets != NULL) {
+            utFree(level->mportNets);
+        }
+        if(level->params != NULL) {
+            utFree(level->params);
+            utFree(level->paramValues);
+        }
+        if(level->names != NULL) {
+            utFree(level->names);
+        }
+    }
+    if(cirFlatLevels != NULL) {
+        utFree(cirFlatLevels);
+    }
+    if(cirFlatPrefix != NULL) {
+        utFree(cirFlatPrefix);
+    }
+    if(cirFlatValue != NULL) {
+        utFree(cirFlatValue);
+    }
+}
+
 /*--------------------------------------------------------------------------------------------------
   Initialize memory used in the spice netlister.
 --------------------------------------------------------------------------------------------------*/
@@ -741,7 +1421,23 @@ void cirStart(
     cirLineSize = 42;
     cirLine = utNewA(char, cirLineSize);
     cirLinePos = 0;
+    cirOutput = utNewA(char, CIR_OUTPUT_SIZE);
+    cirOutputPos = 0;
     cirLastBreakPos = UINT32_MAX;
+    cirFlatSpice = dbFlatSpice;
+    cirPreserveDesign = dbPreserveDesign && !cirFlatSpice;
+    cirFlatLevels = NULL;
+    cirFlatDepth = 0;
+    cirMaxFlatDepth = 0;
+    cirFlatPrefix = NULL;
+    cirFlatPrefixSize = 0;
+    cirFlatValue = NULL;
+    cirFlatValueSize = 0;
+    cirCurrentInstView = cirInstViewNull;
+    cirBitPorts = NULL;
+    cirBitMports = NULL;
+    cirMaxBitPorts = 0;
+    cirNumBitPorts = 0;
     cirTarget = targetType;
     cirUseBracesAroundParams = true;
     cirDeclareParameters = false;
@@ -771,13 +1467,22 @@ void cirStart(
 void cirStop(void)
 {
     utFree(cirLine);
+    utFree(cirOutput);
+    if(cirBitPorts != NULL) {
+        utFree(cirBitPorts);
+        utFree(cirBitMports);
+    }
+    freeFlatLevels();
     cirRootDestroy(cirTheRoot);
     cirDatabaseStop();
 }
 
 /*--------------------------------------------------------------------------------------------------
   Write out a SPICE design.  Note: This may modify the netlist if there are non-spice compatible
-  things in it.  Consider making a copy of the netlist first if this is a problem.
+  things in it, unless dbPreserveDesign is set, in which case it is written from views of the
+  design instead.  Another way is to write a copy made with dbDesignClone.  Writing flat with
+  dbFlatSpice set makes the same changes, so with dbPreserveDesign also set, they are made on a
+  copy that is destroyed afterwards.
 --------------------------------------------------------------------------------------------------*/
 bool cirWriteDesign(
     dbDesign design,
@@ -786,6 +1491,7 @@ bool cirWriteDesign(
     uint32 maxLineLength,
     bool wholeLibrary)
 {
+    dbDesign flatCopy = dbDesignNull;
     char *exeName;
     char *localFileName = utNewA(char, strlen(fileName) + 1);
 
@@ -796,6 +1502,10 @@ bool cirWriteDesign(
         cirMaxLineLength = UINT32_MAX;
     }
     strcpy(localFileName, fileName);
+    if(dbFlatSpice && dbPreserveDesign) {
+        flatCopy = dbDesignClone(design, findCopyName(design));
+        design = flatCopy;
+    }
     cirStart(design, dbSpiceTarget);
     if(!cirBuildDevices()) {
         utWarning("Could not build SPICE device configuration data");
@@ -804,6 +1514,9 @@ bool cirWriteDesign(
         if(cirFile == NULL) {
             utWarning("Could not open file %s", localFileName);
             cirStop();
+            if(flatCopy != dbDesignNull) {
+                dbDesignDestroy(flatCopy);
+            }
             utFree(localFileName);
             return false;
         }
@@ -812,15 +1525,26 @@ bool cirWriteDesign(
             utGetDateAndTime(), exeName, utGetVersion());
         cirPrint("* Symbol search path = %s\n", dbGschemComponentPath);
         cirPrint("* Schematic search path = %s\n", dbGschemSourcePath);
-        dbDesignSetNetNamesToMatchMports(design);
-        dbDesignConvertPowerInstsToGlobals(design);
-        dbDesignExplodeArrayInsts(design);
-        dbDesignEliminateNonAlnumChars(design);
-        writeDesign(design, includeTopLevelPorts, wholeLibrary);
+        if(cirPreserveDesign) {
+            cirStartView(design);
+        } else {
+            dbDesignSetNetNamesToMatchMports(design);
+            dbDesignConvertPowerInstsToGlobals(design);
+            dbDesignExplodeArrayInsts(design);
+            dbDesignEliminateNonAlnumChars(design);
+        }
+        if(cirFlatSpice) {
+            writeFlatDesign(design, includeTopLevelPorts);
+        } else {
+            writeDesign(design, includeTopLevelPorts, wholeLibrary);
+        }
         flushBuffer();
         fclose(cirFile);
     }
     cirStop();
+    if(flatCopy != dbDesignNull) {
+        dbDesignDestroy(flatCopy);
+    }
     utFree(localFileName);
     return true;
 }
@@ -1,3 +1,4 @@
+#include <stdlib.h>
 #include <string.h>
 #include "db.h"
 #include "schext.h"
@@ -401,7 +402,11 @@ int read_library(
         dbCurrentLibrary = vrReadDesign(libraryName, fileName, dbCurrentLibrary);
         break;
     case DB_SPICE:
-        dbCurrentLibrary = cirReadDesign(libraryName, fileName, dbCurrentLibrary);
+        if(dbLazyLibraries) {
+            dbCurrentLibrary = cirIndexLibrary(libraryName, fileName, dbCurrentLibrary);
+        } else {
+            dbCurrentLibrary = cirReadDesign(libraryName, fileName, dbCurrentLibrary);
+        }
         break;
     case DB_SCHEMATIC:
         dbCurrentLibrary = schReadSchematic(libraryName, fileName, dbCurrentLibrary);
@@ -567,6 +572,29 @@ void rename_netlist(
     }
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Copy a design.  The copy can then be changed, or written destructively, without touching the
+  original.
+--------------------------------------------------------------------------------------------------*/
+int copy_design(
+    char *designName,
+    char *newDesignName)
+{
+    dbDesign design = dbRootFindDesign(dbTheRoot, utSymCreate(designName));
+    utSym newName = utSymCreate(newDesignName);
+
+    if(design == dbDesignNull) {
+        utWarning("copy_design: Unable to locate design %s in the database", designName);
+        return 0;
+    }
+    if(dbRootFindDesign(dbTheRoot, newName) != dbDesignNull) {
+        utWarning("copy_design: Design %s already exists", newDesignName);
+        return 0;
+    }
+    dbDesignClone(design, newName);
+    return 1;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Set all names in the netlist to  upper case.
 --------------------------------------------------------------------------------------------------*/
@@ -980,6 +1008,218 @@ void set_library_wins(
     dbRootSetLibraryWins(dbTheRoot, value? true : false);
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Setting this makes read_library just index SPICE libraries.  Sub-circuits are then read from the
+  library only when a later read_netlist of a SPICE design instantiates them.
+--------------------------------------------------------------------------------------------------*/
+void set_lazy_libraries(
+    int value)
+{
+    dbRootSetLazyLibraries(dbTheRoot, value? true : false);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Setting this makes SPICE writers leave the design as it is.  Names are munged, and instance arrays
+  exploded, only in the netlist written out.
+--------------------------------------------------------------------------------------------------*/
+void set_preserve_design(
+    int value)
+{
+    dbRootSetPreserveDesign(dbTheRoot, value? true : false);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Set the number of threads used by readers and writers that can work in parallel.  A value of 1
+  makes everything run in the main thread.
+--------------------------------------------------------------------------------------------------*/
+void set_num_threads(
+    int value)
+{
+    if(value < 1) {
+        utWarning("set_num_threads: The number of threads must be at least 1");
+        return;
+    }
+    dbRootSetNumThreads(dbTheRoot, value);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Set the file used to cache parsed symbols between runs.  An empty name turns off the cache.
+--------------------------------------------------------------------------------------------------*/
+void set_symbol_cache(
+    char *fileName)
+{
+    dbRootResizeSymbolCacheFiles(dbTheRoot, strlen(fileName) + 1);
+    strcpy(dbSymbolCacheFile, fileName);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the current design, and build its flat view if it has none.
+--------------------------------------------------------------------------------------------------*/
+static dbDesign findFlatDesign(
+    char *command)
+{
+    dbDesign design = dbRootGetCurrentDesign(dbTheRoot);
+
+    if(design == dbDesignNull) {
+        utWarning("%s: no current design", command);
+        return dbDesignNull;
+    }
+    if(dbDesignFindHier(design) == dbHierNull) {
+        utWarning("%s: the current design has no root netlist", command);
+        return dbDesignNull;
+    }
+    return design;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Build the flat view of the current design.  It is built again when instances, nets, ports or
+  mports are created or destroyed, but other changes, such as moving a port to another net, need
+  this.
+--------------------------------------------------------------------------------------------------*/
+int build_flat_view(void)
+{
+    dbDesign design = dbRootGetCurrentDesign(dbTheRoot);
+
+    if(design == dbDesignNull) {
+        utWarning("build_flat_view: no current design");
+        return 0;
+    }
+    return dbDesignBuildHier(design) != dbHierNull;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Count the devices in the flat view of the current design.
+--------------------------------------------------------------------------------------------------*/
+char *get_num_flat_devices(void)
+{
+    dbDesign design = findFlatDesign("get_num_flat_devices");
+
+    if(design == dbDesignNull) {
+        return "0";
+    }
+    return utSprintf("%llu", (unsigned long long)dbDesignGetNumFlatDevices(design));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Count the nets in the flat view of the current design.
+--------------------------------------------------------------------------------------------------*/
+char *get_num_flat_nets(void)
+{
+    dbDesign design = findFlatDesign("get_num_flat_nets");
+
+    if(design == dbDesignNull) {
+        return "0";
+    }
+    return utSprintf("%llu", (unsigned long long)dbDesignGetNumFlatNets(design));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Get the hierarchical name of a device in the flat view, by its number.
+--------------------------------------------------------------------------------------------------*/
+char *get_flat_device_name(
+    char *deviceId)
+{
+    dbDesign design = findFlatDesign("get_flat_device_name");
+    dbHierPath path;
+    char *name;
+
+    if(design == dbDesignNull) {
+        return "";
+    }
+    path = dbHierPathCreate(design);
+    if(!dbHierPathSetDevice(path, strtoull(deviceId, NULL, 10))) {
+        utWarning("get_flat_device_name: no device numbered %s", deviceId);
+        dbHierPathFree(path);
+        return "";
+    }
+    name = utCopyString(dbHierPathGetName(path, '/'));
+    dbHierPathFree(path);
+    return name;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Get the hierarchical name of a net in the flat view, by its number.
+--------------------------------------------------------------------------------------------------*/
+char *get_flat_net_name(
+    char *netId)
+{
+    dbDesign design = findFlatDesign("get_flat_net_name");
+    dbHierPath path;
+    dbNet net;
+    char *name;
+
+    if(design == dbDesignNull) {
+        return "";
+    }
+    path = dbHierPathCreate(design);
+    net = dbHierPathSetNet(path, strtoull(netId, NULL, 10));
+    if(net == dbNetNull) {
+        utWarning("get_flat_net_name: no net numbered %s", netId);
+        dbHierPathFree(path);
+        return "";
+    }
+    name = utCopyString(dbHierPathGetNetName(path, net, '/'));
+    dbHierPathFree(path);
+    return name;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Get the hierarchical name of the flat net on a pin of a device in the flat view.
+--------------------------------------------------------------------------------------------------*/
+char *get_flat_device_net(
+    char *deviceId,
+    char *pinName)
+{
+    dbDesign design = findFlatDesign("get_flat_device_net");
+    dbHierPath path;
+    dbInst inst;
+    dbMport mport;
+    dbPort port;
+    dbNet net;
+    char *name;
+
+    if(design == dbDesignNull) {
+        return "";
+    }
+    path = dbHierPathCreate(design);
+    if(!dbHierPathSetDevice(path, strtoull(deviceId, NULL, 10))) {
+        utWarning("get_flat_device_net: no device numbered %s", deviceId);
+        dbHierPathFree(path);
+        return "";
+    }
+    inst = dbHierPathGetInst(path);
+    mport = dbNetlistFindMport(dbInstGetInternalNetlist(inst), utSymCreate(pinName));
+    port = mport == dbMportNull? dbPortNull : dbFindPortFromInstMport(inst, mport);
+    if(port == dbPortNull || dbPortGetNet(port) == dbNetNull) {
+        utWarning("get_flat_device_net: device %s has no net on pin %s", deviceId, pinName);
+        dbHierPathFree(path);
+        return "";
+    }
+    dbHierPathPop(path); /* The device's net is in the netlist holding it */
+    net = dbHierPathTraceNet(path, dbPortGetNet(port));
+    name = utCopyString(dbHierPathGetNetName(path, net, '/'));
+    dbHierPathFree(path);
+    return name;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Set whether SPICE is written flat.
+--------------------------------------------------------------------------------------------------*/
+void set_flat_spice(
+    int value)
+{
+    dbRootSetFlatSpice(dbTheRoot, value? true : false);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Set whether the Verilog reader builds instances while it parses.
+--------------------------------------------------------------------------------------------------*/
+void set_stream_verilog(
+    int value)
+{
+    dbRootSetStreamVerilog(dbTheRoot, value? true : false);
+}
+
 /*--------------------------------------------------------------------------------------------------
   Temp hack to set resistor names.
 --------------------------------------------------------------------------------------------------*/
@@ -1008,6 +1248,17 @@ void save_database(
     fclose(file);
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Reset global object handles after the database has been loaded.
+--------------------------------------------------------------------------------------------------*/
+static void resetGlobalsAfterLoad(void)
+{
+    dbTheRoot = dbFirstRoot();
+    dbGraphicalSym = utSymCreate("graphical");
+    geRES250Sym = utSymCreate("RES250");
+    geRES6KSym = utSymCreate("RES6K");
+}
+
 /*--------------------------------------------------------------------------------------------------
   Load the database in binary format.
 --------------------------------------------------------------------------------------------------*/
@@ -1022,9 +1273,35 @@ void load_database(
     }
     utLogMessage("Reading database from %s", fileName);
     utLoadTextDatabase(file);
-    dbTheRoot = dbFirstRoot();
-    dbGraphicalSym = utSymCreate("graphical");
-    geRES250Sym = utSymCreate("RES250");
-    geRES6KSym = utSymCreate("RES6K");
+    resetGlobalsAfterLoad();
     fclose(file);
 }
+
+/*--------------------------------------------------------------------------------------------------
+  Save the database as a binary snapshot, which is much faster to load than save_database files.
+--------------------------------------------------------------------------------------------------*/
+int save_snapshot(
+    char *fileName)
+{
+    utLogMessage("Saving database snapshot to %s", fileName);
+    if(!dbSaveSnapshot(fileName)) {
+        utWarning("save_snapshot: Unable to write snapshot %s", fileName);
+        return 0;
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Load a database snapshot written by save_snapshot.
+--------------------------------------------------------------------------------------------------*/
+int load_snapshot(
+    char *fileName)
+{
+    utLogMessage("Reading database snapshot from %s", fileName);
+    if(!dbLoadSnapshot(fileName)) {
+        utWarning("load_snapshot: Unable to read snapshot %s", fileName);
+        return 0;
+    }
+    resetGlobalsAfterLoad();
+    return 1;
+}
@@ -29,6 +29,7 @@ extern void thread_globals_through_hierarchy(int createTopLevelPorts);
 extern void rename_global(char *globalName, char *newGlobalName);
 extern void rename_netlist(char *netlistName, char *newNetlistName);
 extern int make_netlists_upper_case(char *designName);
+extern int copy_design(char *designName, char *newDesignName);
 extern void set_netlist_value(char *netlistName, char *propName, char *value);
 extern char *get_netlist_value(char *netlistName, char *propName);
 extern void set_inst_value(char *instName, char *propName, char *value);
@@ -48,6 +49,20 @@ extern int inst_exists(char *instName);
 extern void report_port_sums(char *deviceType, char *pinType, char *expression);
 extern void report_portlist_sums(char *pinList, char *expression);
 extern void set_library_wins(int value);
+extern void set_lazy_libraries(int value);
+extern void set_preserve_design(int value);
+extern void set_num_threads(int value);
+extern void set_symbol_cache(char *fileName);
+extern int build_flat_view(void);
+extern char *get_num_flat_devices(void);
+extern char *get_num_flat_nets(void);
+extern char *get_flat_device_name(char *deviceId);
+extern char *get_flat_net_name(char *netId);
+extern char *get_flat_device_net(char *deviceId, char *pinName);
+extern void set_flat_spice(int value);
+extern void set_stream_verilog(int value);
 extern void set_resistor_names(char *res250, char *res6k);
 extern void save_database(char *fileName);
 extern void load_database(char *fileName);
+extern int save_snapshot(char *fileName);
+extern int load_snapshot(char *fileName);
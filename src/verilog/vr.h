@@ -22,6 +22,7 @@
 
 /* Constructors */
 extern dbNetlist vrNetlistCreate(dbDesign design, utSym name, dbNetlistType type);
+extern void vrFinishIdec(vrIdec idec);
 
 /* I/O */
 extern void vrPrint(char *newLineText, char *format, ...);
@@ -29,12 +30,23 @@ extern void vrPrintLn(char *newLineText, char *format, ...);
 extern char *vrMunge(char *name);
 extern char *vrMungeBus(char *name);
 
+/* Input files, in vrload.c */
+extern bool vrStartInput(char *fileName);
+extern bool vrNextInput(void);
+extern bool vrPushInclude(char *fileName);
+extern void vrPopInclude(void);
+extern void vrStopInput(void);
+
 /* Globals */
 extern dbDesign vrCurrentDesign;
 extern FILE *vrFile;
-extern uint32 vrFileSize, vrLineNum, vrCharCount, vrLinePos;
+extern char *vrFileName;
+extern uint64 vrFileSize, vrCharCount;
+extern uint32 vrLineNum, vrLinePos;
 
 /* Lex, Yacc stuff */
+extern int vrRead(char *buf, int maxSize);
+extern void vrResetScanner(void);
 extern int vrparse();
 extern int vrlex();
 extern void vrerror(char *message, ...);
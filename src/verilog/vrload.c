@@ -0,0 +1,736 @@
+/*
+ * Copyright (C) 2004 ViASIC
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License 
+ * along with this program; if not, write to the Free Software 
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111 USA
+ */
+
+/*--------------------------------------------------------------------------------------------------
+  Verilog input.  A design may be read from one file, or from a filelist naming many files, which
+  are scanned one after the other as if they were one file.  `include directives open a file in
+  the middle of another, and the scanner goes back to the including file at the end of it.
+
+  With more than one file listed, loader threads read the files into memory ahead of the scanner,
+  a few at a time, and strip out carriage returns.  The parser and the database are not thread
+  safe, so modules are still built by the main thread, in the order the files are listed.  The
+  loader threads only use the records in this file, and plain malloc.
+
+  Files the loader doesn't have are mapped into memory when possible, and otherwise read in
+  blocks with fread.
+--------------------------------------------------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#endif
+#include "vr.h"
+
+#define VR_MAX_FILELIST_DEPTH 16
+#define VR_LOAD_FILES_PER_THREAD 2
+
+/* A file being scanned */
+typedef struct vrInputStruct *vrInput;
+struct vrInputStruct {
+    char *fileName;
+    char *text; /* Mapped or loaded text, or NULL if reading with fread */
+    uint64 length, pos;
+    FILE *file;
+    bool mapped;
+    uint32 lineNum; /* Line to go back to in the file that included this one */
+    vrInput includer;
+};
+
+char *vrFileName;
+static vrInput vrCurrentInput;
+static char **vrFileNames, **vrIncludeDirs;
+static uint32 vrNumFiles, vrMaxFiles, vrNumIncludeDirs, vrMaxIncludeDirs, vrNextFile;
+static uint8 vrProgress;
+
+/*--------------------------------------------------------------------------------------------------
+  Read the whole file into memory allocated with malloc.  Return NULL if it can't be opened.
+--------------------------------------------------------------------------------------------------*/
+static char *readFile(
+    char *fileName,
+    size_t *lengthPtr)
+{
+    FILE *stream = fopen(fileName, "rb");
+    size_t size = 1 << 16;
+    size_t length = 0;
+    char *text;
+
+    if(stream == NULL) {
+        return NULL;
+    }
+    text = malloc(size);
+    while(!feof(stream) && !ferror(stream)) {
+        if(length + 1 == size) {
+            size <<= 1;
+            text = realloc(text, size);
+        }
+        length += fread(text + length, 1, size - length - 1, stream);
+    }
+    fclose(stream);
+    text[length] = '\0';
+    *lengthPtr = length;
+    return text;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Copy the text, leaving out carriage returns, and return the new length.  The source and
+  destination may be the same.  Returns are found with memchr, so runs of text between them are
+  moved a block at a time.
+--------------------------------------------------------------------------------------------------*/
+static size_t copyWithoutReturns(
+    char *dest,
+    char *source,
+    size_t length)
+{
+    char *end = source + length;
+    char *start = dest;
+    char *p;
+
+    while(source < end) {
+        p = memchr(source, '\r', end - source);
+        if(p == NULL) {
+            p = end;
+        }
+        if(dest != source) {
+            memmove(dest, source, p - source);
+        }
+        dest += p - source;
+        source = p < end? p + 1 : end;
+    }
+    return dest - start;
+}
+
+#ifndef _WIN32
+/* A listed file read by the loader */
+typedef struct vrLoadFileStruct *vrLoadFile;
+struct vrLoadFileStruct {
+    char *text; /* NULL if the file could not be read */
+    size_t length;
+    bool loaded;
+};
+
+static pthread_mutex_t vrLoadMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t vrLoadCond = PTHREAD_COND_INITIALIZER;
+static pthread_t *vrLoadThreads;
+static uint32 vrNumLoadThreads;
+static bool vrLoaderRunning, vrLoaderStopping;
+static vrLoadFile vrLoadFiles;
+static uint32 vrNextLoadFile; /* Next file for a loader thread to read */
+static uint32 vrMaxLoadFile; /* Loader threads stay this far ahead of the scanner */
+
+/*--------------------------------------------------------------------------------------------------
+  Read the listed file into memory, without carriage returns.
+--------------------------------------------------------------------------------------------------*/
+static void loadFile(
+    uint32 xFile)
+{
+    vrLoadFile file = vrLoadFiles + xFile;
+
+    file->text = readFile(vrFileNames[xFile], &file->length);
+    if(file->text != NULL) {
+        file->length = copyWithoutReturns(file->text, file->text, file->length);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Loader thread: read listed files in order until we're stopped.
+--------------------------------------------------------------------------------------------------*/
+static void *loadThread(
+    void *arg)
+{
+    uint32 xFile;
+
+    pthread_mutex_lock(&vrLoadMutex);
+    while(!vrLoaderStopping) {
+        if(vrNextLoadFile < vrNumFiles && vrNextLoadFile < vrMaxLoadFile) {
+            xFile = vrNextLoadFile++;
+            pthread_mutex_unlock(&vrLoadMutex);
+            loadFile(xFile);
+            pthread_mutex_lock(&vrLoadMutex);
+            vrLoadFiles[xFile].loaded = true;
+            pthread_cond_broadcast(&vrLoadCond);
+        } else {
+            pthread_cond_wait(&vrLoadCond, &vrLoadMutex);
+        }
+    }
+    pthread_mutex_unlock(&vrLoadMutex);
+    return NULL;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Start the loader threads, if there is more than one file and more than one thread is allowed.
+--------------------------------------------------------------------------------------------------*/
+static void startLoader(void)
+{
+    uint32 xThread;
+
+    if(dbNumThreads <= 1 || vrNumFiles <= 1) {
+        return;
+    }
+    vrLoadFiles = utNewA(struct vrLoadFileStruct, vrNumFiles);
+    memset(vrLoadFiles, 0, vrNumFiles*sizeof(struct vrLoadFileStruct));
+    vrNextLoadFile = 0;
+    vrNumLoadThreads = utMin(dbNumThreads, vrNumFiles);
+    vrMaxLoadFile = vrNumLoadThreads*VR_LOAD_FILES_PER_THREAD;
+    vrLoaderStopping = false;
+    vrLoaderRunning = true;
+    vrLoadThreads = utNewA(pthread_t, vrNumLoadThreads);
+    for(xThread = 0; xThread < vrNumLoadThreads; xThread++) {
+        pthread_create(vrLoadThreads + xThread, NULL, loadThread, NULL);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Stop the loader threads, and free any text the scanner did not get to.
+--------------------------------------------------------------------------------------------------*/
+static void stopLoader(void)
+{
+    uint32 xThread, xFile;
+
+    if(!vrLoaderRunning) {
+        return;
+    }
+    pthread_mutex_lock(&vrLoadMutex);
+    vrLoaderStopping = true;
+    pthread_cond_broadcast(&vrLoadCond);
+    pthread_mutex_unlock(&vrLoadMutex);
+    for(xThread = 0; xThread < vrNumLoadThreads; xThread++) {
+        pthread_join(vrLoadThreads[xThread], NULL);
+    }
+    utFree(vrLoadThreads);
+    for(xFile = 0; xFile < vrNumFiles; xFile++) {
+        free(vrLoadFiles[xFile].text);
+    }
+    utFree(vrLoadFiles);
+    vrLoaderRunning = false;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Take the text of the listed file from the loader, waiting for it if needed.  If no loader thread
+  has started on it, read it here.  The caller frees the text.  Return NULL if the loader is not
+  running, or the file could not be read.
+--------------------------------------------------------------------------------------------------*/
+static char *takeLoadedFile(
+    uint32 xFile,
+    size_t *lengthPtr)
+{
+    vrLoadFile file;
+    char *text;
+
+    if(!vrLoaderRunning) {
+        return NULL;
+    }
+    file = vrLoadFiles + xFile;
+    pthread_mutex_lock(&vrLoadMutex);
+    vrMaxLoadFile = xFile + 1 + vrNumLoadThreads*VR_LOAD_FILES_PER_THREAD;
+    pthread_cond_broadcast(&vrLoadCond);
+    if(xFile >= vrNextLoadFile) {
+        vrNextLoadFile = xFile + 1;
+        pthread_mutex_unlock(&vrLoadMutex);
+        loadFile(xFile);
+        pthread_mutex_lock(&vrLoadMutex);
+        file->loaded = true;
+    }
+    while(!file->loaded) {
+        pthread_cond_wait(&vrLoadCond, &vrLoadMutex);
+    }
+    text = file->text;
+    file->text = NULL;
+    pthread_mutex_unlock(&vrLoadMutex);
+    *lengthPtr = file->length;
+    return text;
+}
+
+#else
+
+/*--------------------------------------------------------------------------------------------------
+  Without pthreads, files are just read directly.
+--------------------------------------------------------------------------------------------------*/
+static void startLoader(void)
+{
+}
+
+static void stopLoader(void)
+{
+}
+
+static char *takeLoadedFile(
+    uint32 xFile,
+    size_t *lengthPtr)
+{
+    return NULL;
+}
+
+#endif
+
+/*--------------------------------------------------------------------------------------------------
+  Find the size of the file, or 0 if it can't be found.
+--------------------------------------------------------------------------------------------------*/
+static uint64 findFileSize(
+    char *fileName)
+{
+#ifndef _WIN32
+    struct stat fileStat;
+
+    if(stat(fileName, &fileStat)) {
+        return 0;
+    }
+    return fileStat.st_size;
+#else
+    return utFindFileSize(fileName);
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Open a file to scan.  Where we can, we map it into memory, and the scanner copies blocks from
+  the page cache.  Otherwise, it reads blocks with fread.  Return NULL if it can't be opened.
+--------------------------------------------------------------------------------------------------*/
+static vrInput openInput(
+    char *fileName,
+    char *text,
+    size_t length)
+{
+    vrInput input = utNew(struct vrInputStruct);
+#ifndef _WIN32
+    struct stat fileStat;
+    int fd;
+#endif
+
+    memset(input, 0, sizeof(struct vrInputStruct));
+    input->fileName = utAllocString(fileName);
+    if(text != NULL) {
+        input->text = text;
+        input->length = length;
+        return input;
+    }
+#ifndef _WIN32
+    fd = open(fileName, O_RDONLY);
+    if(fd >= 0 && !fstat(fd, &fileStat) && fileStat.st_size > 0) {
+        input->text = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(input->text != MAP_FAILED) {
+            close(fd);
+            madvise(input->text, fileStat.st_size, MADV_SEQUENTIAL);
+            input->length = fileStat.st_size;
+            input->mapped = true;
+            return input;
+        }
+        input->text = NULL;
+    }
+    if(fd >= 0) {
+        close(fd);
+    }
+#endif
+    input->file = fopen(fileName, "rb");
+    if(input->file == NULL) {
+        utFree(input->fileName);
+        utFree(input);
+        return NULL;
+    }
+    return input;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Close a file opened with openInput.
+--------------------------------------------------------------------------------------------------*/
+static void closeInput(
+    vrInput input)
+{
+#ifndef _WIN32
+    if(input->mapped) {
+        munmap(input->text, input->length);
+        input->text = NULL;
+    }
+#endif
+    if(input->text != NULL) {
+        free(input->text);
+    } else if(input->file != NULL) {
+        fclose(input->file);
+    }
+    utFree(input->fileName);
+    utFree(input);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Make the input the current one.
+--------------------------------------------------------------------------------------------------*/
+static void setCurrentInput(
+    vrInput input)
+{
+    vrCurrentInput = input;
+    vrFileName = input == NULL? NULL : input->fileName;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a name to an array of names.
+--------------------------------------------------------------------------------------------------*/
+static void addName(
+    char ***namesPtr,
+    uint32 *numNamesPtr,
+    uint32 *maxNamesPtr,
+    char *name)
+{
+    if(*numNamesPtr == *maxNamesPtr) {
+        *maxNamesPtr = *maxNamesPtr == 0? 16 : *maxNamesPtr << 1;
+        if(*namesPtr == NULL) {
+            *namesPtr = utNewA(char *, *maxNamesPtr);
+        } else {
+            utResizeArray(*namesPtr, *maxNamesPtr);
+        }
+    }
+    (*namesPtr)[(*numNamesPtr)++] = utAllocString(name);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the path to the file, relative to the directory, unless it is absolute or there is no
+  directory.
+--------------------------------------------------------------------------------------------------*/
+static char *findRelativePath(
+    char *dirName,
+    char *fileName)
+{
+    if(dirName == NULL || *fileName == '/') {
+        return fileName;
+    }
+    return utSprintf("%s/%s", dirName, fileName);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the directory the file is in, or NULL if it's in the current directory.  The result is a
+  temporary string.
+--------------------------------------------------------------------------------------------------*/
+static char *findDirName(
+    char *fileName)
+{
+    char *dirName = utCopyString(fileName);
+    char *p = strrchr(dirName, '/');
+
+    if(p == NULL) {
+        return NULL;
+    }
+    if(p == dirName) {
+        return "/";
+    }
+    *p = '\0';
+    return dirName;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Find the next word in the filelist text, skipping comments.  Return NULL at the end.
+--------------------------------------------------------------------------------------------------*/
+static char *findNextWord(
+    char **textPtr)
+{
+    char *p = *textPtr;
+    char *word;
+
+    utDo {
+        while(*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
+            p++;
+        }
+    } utWhile(*p == '#' || (*p == '/' && p[1] == '/')) {
+        while(*p != '\0' && *p != '\n') {
+            p++;
+        }
+    } utRepeat;
+    if(*p == '\0') {
+        return NULL;
+    }
+    word = p;
+    while(*p != '\0' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+        p++;
+    }
+    if(*p != '\0') {
+        *p++ = '\0';
+    }
+    *textPtr = p;
+    return word;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Read a filelist.  It names Verilog files, separated by white space, with comments starting with
+  // or #.  Nested filelists are read with "-f file", where names are relative to the current
+  directory, or "-F file", where they are relative to that filelist's directory.  Include
+  directories are added with +incdir+dir1+dir2, and "-v file" names a library file to read like
+  any other.  Other options are ignored.  Return false if the filelist can't be read.
+--------------------------------------------------------------------------------------------------*/
+static bool readFileList(
+    char *fileName,
+    char *dirName,
+    uint32 depth)
+{
+    size_t length;
+    char *text = readFile(fileName, &length);
+    char *p = text;
+    char *word, *incdir, *next, *nextDirName;
+
+    if(text == NULL) {
+        utWarning("Could not read filelist %s", fileName);
+        return false;
+    }
+    if(depth == VR_MAX_FILELIST_DEPTH) {
+        utWarning("Filelists nested too deeply at %s", fileName);
+        free(text);
+        return false;
+    }
+    while((word = findNextWord(&p)) != NULL) {
+        if(!strcmp(word, "-f") || !strcmp(word, "-F")) {
+            next = findNextWord(&p);
+            if(next != NULL) {
+                next = utAllocString(findRelativePath(dirName, next));
+                nextDirName = findDirName(next);
+                if(word[1] == 'F' && nextDirName != NULL) {
+                    nextDirName = utAllocString(nextDirName);
+                    readFileList(next, nextDirName, depth + 1);
+                    utFree(nextDirName);
+                } else {
+                    readFileList(next, NULL, depth + 1);
+                }
+                utFree(next);
+            }
+        } else if(!strcmp(word, "-v")) {
+            next = findNextWord(&p);
+            if(next != NULL) {
+                addName(&vrFileNames, &vrNumFiles, &vrMaxFiles, findRelativePath(dirName, next));
+            }
+        } else if(!strncmp(word, "+incdir+", 8)) {
+            for(incdir = strtok(word + 8, "+"); incdir != NULL; incdir = strtok(NULL, "+")) {
+                addName(&vrIncludeDirs, &vrNumIncludeDirs, &vrMaxIncludeDirs,
+                    findRelativePath(dirName, incdir));
+            }
+        } else if(*word == '-' || *word == '+') {
+            utWarning("Ignoring option %s in filelist %s", word, fileName);
+        } else {
+            addName(&vrFileNames, &vrNumFiles, &vrMaxFiles, findRelativePath(dirName, word));
+        }
+    }
+    free(text);
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Open the listed file.  Return false if it can't be opened.
+--------------------------------------------------------------------------------------------------*/
+static bool openListedFile(
+    uint32 xFile)
+{
+    size_t length;
+    char *text = takeLoadedFile(xFile, &length);
+    vrInput input;
+
+    input = openInput(vrFileNames[xFile], text, length);
+    if(input == NULL) {
+        utWarning("Could not open file %s for reading", vrFileNames[xFile]);
+        return false;
+    }
+    setCurrentInput(input);
+    vrLineNum = 1;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Start reading a Verilog file, or the files named in a filelist, if the name ends in .f.
+  Return false if it can't be read.
+--------------------------------------------------------------------------------------------------*/
+bool vrStartInput(
+    char *fileName)
+{
+    char *suffix = strrchr(fileName, '.');
+    uint32 xFile;
+
+    vrFileNames = NULL;
+    vrIncludeDirs = NULL;
+    vrNumFiles = 0;
+    vrMaxFiles = 0;
+    vrNumIncludeDirs = 0;
+    vrMaxIncludeDirs = 0;
+    vrNextFile = 0;
+    vrProgress = 0;
+    vrCharCount = 0;
+    vrFileSize = 0;
+    setCurrentInput(NULL);
+    if(suffix != NULL && !strcmp(suffix, ".f")) {
+        if(!readFileList(fileName, NULL, 0)) {
+            return false;
+        }
+    } else {
+        addName(&vrFileNames, &vrNumFiles, &vrMaxFiles, fileName);
+    }
+    if(vrNumFiles == 0) {
+        utWarning("No Verilog files listed in %s", fileName);
+        return false;
+    }
+    for(xFile = 0; xFile < vrNumFiles; xFile++) {
+        vrFileSize += findFileSize(vrFileNames[xFile]);
+    }
+    startLoader();
+    return vrNextInput();
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Open the next listed file when the scanner reaches the end of one.  Return false after the last.
+  vrFileName keeps the listed name of the file just closed until another is opened, since the
+  parser can still report errors at the end of the input.
+--------------------------------------------------------------------------------------------------*/
+bool vrNextInput(void)
+{
+    if(vrCurrentInput != NULL) {
+        closeInput(vrCurrentInput);
+        setCurrentInput(NULL);
+        vrFileName = vrFileNames[vrNextFile - 1];
+    }
+    while(vrNextFile < vrNumFiles) {
+        if(openListedFile(vrNextFile++)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Open an `include file.  It is looked for next to the including file, then in the include
+  directories, then in the current directory.  Return false if it can't be found.
+--------------------------------------------------------------------------------------------------*/
+bool vrPushInclude(
+    char *fileName)
+{
+    vrInput input = openInput(findRelativePath(findDirName(vrFileName), fileName), NULL, 0);
+    uint32 xDir;
+
+    for(xDir = 0; input == NULL && xDir < vrNumIncludeDirs; xDir++) {
+        input = openInput(findRelativePath(vrIncludeDirs[xDir], fileName), NULL, 0);
+    }
+    if(input == NULL) {
+        input = openInput(fileName, NULL, 0);
+    }
+    if(input == NULL) {
+        return false;
+    }
+    input->lineNum = vrLineNum;
+    input->includer = vrCurrentInput;
+    setCurrentInput(input);
+    vrLineNum = 1;
+    return true;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Close an `include file at its end, and go back to the file that included it.
+--------------------------------------------------------------------------------------------------*/
+void vrPopInclude(void)
+{
+    vrInput input = vrCurrentInput;
+
+    utAssert(input != NULL && input->includer != NULL);
+    vrLineNum = input->lineNum;
+    setCurrentInput(input->includer);
+    closeInput(input);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Close all input, and free the file lists.
+--------------------------------------------------------------------------------------------------*/
+void vrStopInput(void)
+{
+    vrInput input;
+    uint32 xName;
+
+    while(vrCurrentInput != NULL) {
+        input = vrCurrentInput;
+        setCurrentInput(input->includer);
+        closeInput(input);
+    }
+    vrFileName = NULL;
+    stopLoader();
+    for(xName = 0; xName < vrNumFiles; xName++) {
+        utFree(vrFileNames[xName]);
+    }
+    for(xName = 0; xName < vrNumIncludeDirs; xName++) {
+        utFree(vrIncludeDirs[xName]);
+    }
+    if(vrFileNames != NULL) {
+        utFree(vrFileNames);
+    }
+    if(vrIncludeDirs != NULL) {
+        utFree(vrIncludeDirs);
+    }
+    vrFileNames = NULL;
+    vrIncludeDirs = NULL;
+    vrNumFiles = 0;
+    vrNumIncludeDirs = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Report how far we are through the listed files, when the percentage changes.
+--------------------------------------------------------------------------------------------------*/
+static void reportProgress(void)
+{
+    uint8 percent;
+
+    if(vrFileSize == 0) {
+        return;
+    }
+    percent = (uint8)utMin(100, (100*(double)vrCharCount)/vrFileSize);
+    if(percent != vrProgress) {
+        vrProgress = percent;
+        utSetProgress(percent);
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Fill the scanner's buffer with the next block of the current file.  Return the number of
+  characters, 0 at the end of the file, or -1 on a read error.
+--------------------------------------------------------------------------------------------------*/
+int vrRead(
+    char *buf,
+    int maxSize)
+{
+    vrInput input = vrCurrentInput;
+    size_t numChars = 0;
+    size_t length;
+
+    if(input == NULL) {
+        return 0;
+    }
+    while(numChars == 0) {
+        if(input->text != NULL) {
+            length = input->length - input->pos;
+            if(length > (size_t)maxSize) {
+                length = maxSize;
+            }
+            if(length == 0) {
+                return 0;
+            }
+            numChars = copyWithoutReturns(buf, input->text + input->pos, length);
+            input->pos += length;
+        } else {
+            length = fread(buf, 1, maxSize, input->file);
+            if(length == 0) {
+                return ferror(input->file)? -1 : 0;
+            }
+            numChars = copyWithoutReturns(buf, buf, length);
+        }
+        if(input->includer == NULL) {
+            vrCharCount += length;
+            reportProgress();
+        }
+    }
+    return numChars;
+}
@@ -176,7 +176,7 @@ void vrerror(
     va_start(ap, message);
     buff = utVsprintf(message, ap);
     va_end(ap);
-    utError("Line %d, token \"%s\": %s", vrLineNum, vrtext, buff);
+    utError("%s, line %d, token \"%s\": %s", vrFileName, vrLineNum, vrtext, buff);
 }
 
 %}
@@ -325,6 +325,7 @@ paramPath: IDENT
 ;
 
 instance: instanceHeader '(' instParams ')' ';'
+{ vrFinishIdec(vrCurrentIdec); }
 ;
 
 instanceHeader: IDENT IDENT
@@ -22,7 +22,8 @@
 #include "vr.h"
 
 FILE *vrFile;
-uint32 vrFileSize, vrLineNum, vrCharCount, vrLinePos;
+uint64 vrFileSize, vrCharCount;
+uint32 vrLineNum, vrLinePos;
 dbDesign vrCurrentDesign, vrCurrentLibrary;
 
 /*--------------------------------------------------------------------------------------------------
@@ -469,6 +470,34 @@ static void buildInstances(void)
     } dbEndDesignNetlist;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  When streaming, build the instance for the declaration just parsed and free the declaration, so
+  only one is kept at a time.  Declarations of modules not seen yet are kept for buildInstances.
+--------------------------------------------------------------------------------------------------*/
+void vrFinishIdec(
+    vrIdec idec)
+{
+    dbNetlist netlist = vrIdecGetNetlist(idec);
+    utSym sym = vrIdecGetInternalNetlistSym(idec);
+    dbNetlist internalNetlist;
+    dbInst inst;
+
+    if(!dbStreamVerilog) {
+        return;
+    }
+    internalNetlist = dbDesignFindNetlist(vrCurrentDesign, sym);
+    if(internalNetlist == dbNetlistNull && vrCurrentLibrary != dbDesignNull) {
+        internalNetlist = dbDesignFindNetlist(vrCurrentLibrary, sym);
+    }
+    if(internalNetlist == dbNetlistNull || internalNetlist == netlist ||
+            dbNetlistGetType(internalNetlist) == DB_UNDEFINED_NETLIST) {
+        return;
+    }
+    inst = buildIdecInst(idec);
+    addNetPorts(idec, inst);
+    vrIdecDestroy(idec);
+}
+
 /*--------------------------------------------------------------------------------------------------
   Find the instance refered to by the path.
 --------------------------------------------------------------------------------------------------*/
@@ -594,27 +623,34 @@ dbDesign vrReadDesign(
     utSym name = utSymCreate(designName);
 
     utLogMessage("Reading Verilog file %s", fileName);
-    vrFileSize = utFindFileSize(fileName);
-    vrFile = fopen(fileName, "r");
-    if(!vrFile) {
-        utWarning("Could not open file %s for reading", fileName);
+    if(!vrStartInput(fileName)) {
+        vrStopInput();
         return dbDesignNull;
     }
-    vrCharCount = 0;
-    vrLineNum = 1;
     vrCurrentLibrary = libDesign;
     vrCurrentDesign = dbRootFindDesign(dbTheRoot, name);
     if(vrCurrentDesign == dbDesignNull) {
         vrCurrentDesign = dbDesignCreate(name, libDesign);
     }
     vrInit();
+    vrResetScanner();
+    if(utSetjmp()) {
+        /* A parse error unwound out of vrparse, so stop the loader threads before going on up */
+        vrStopInput();
+        vrClose();
+        dbDesignDestroy(vrCurrentDesign);
+        return dbDesignNull;
+    }
     if(vrparse()) {
-        fclose(vrFile);
+        utUnsetjmp();
+        vrStopInput();
         vrClose();
         dbDesignDestroy(vrCurrentDesign);
         return dbDesignNull;
     }
-    fclose(vrFile);
+    utUnsetjmp();
+    vrStopInput();
+    utSetProgress(100);
     checkForImplicitModules(vrCurrentDesign);
     buildInstances();
     evaluateDefparams();
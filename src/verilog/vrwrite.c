@@ -22,122 +22,172 @@
 
 #include <stdarg.h>
 #include <string.h>
-#include "htext.h"
 #include "vr.h"
 
 #define VR_WRAP_COLUMN 100
+#define VR_OUTPUT_SIZE (1 << 20)
+#define VR_KEYWORD_TABLE_SIZE 231
+#define VR_MIN_KEYWORD_LENGTH 2
+#define VR_MAX_KEYWORD_LENGTH 12
 
-static htHtbl vrKeywordTable;
-
-/*--------------------------------------------------------------------------------------------------
-  Iinitialize the keyword hash table.
---------------------------------------------------------------------------------------------------*/
-static void buildKeywordTable(void)
-{
-    vrKeywordTable = htHtblCreate();
-    htHtblAddSym(vrKeywordTable, utSymCreate("always"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("and"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("assign"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("attribute"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("begin"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("buf"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("bufif0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("bufif1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("case"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("casex"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("casez"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("cmos"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("deassign"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("default"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("defparam"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("disable"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("edge"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("else"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("end"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("endattribute"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("endcase"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("endfunction endmodule"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("endprimitive"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("endspecify"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("endtable"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("endtask"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("event"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("for"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("force"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("forever"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("fork"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("function"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("highz0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("highz1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("if"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("ifnone"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("initial"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("inout"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("input"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("integer"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("join"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("medium"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("module large"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("macromodule"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("nand"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("negedge"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("nmos"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("nor"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("not"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("notif0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("notif1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("or"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("output"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("parameter"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("pmos"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("posedge"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("primitive"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("pull0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("pull1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("pulldown"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("pullup"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("rcmos"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("real"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("realtime reg"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("release"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("repeat"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("rnmos"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("rpmos"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("rtran"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("rtranif0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("rtranif1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("scalared"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("signed"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("small"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("specify"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("specparam"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("strength"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("strong0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("strong1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("supply0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("supply1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("table"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("task"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("time"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("tran tranif0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("tranif1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("tri"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("tri0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("tri1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("triand"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("trior"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("trireg"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("unsigned"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("vectored"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("wait"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("wand"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("weak0"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("weak1"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("while"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("wire"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("wor"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("xnor"));
-    htHtblAddSym(vrKeywordTable, utSymCreate("xor"));
+/* Munged names written so far, indexed by utSym2Index.  Names that need no munging point to the
+   symbol's own name, and the rest are allocated. */
+static char **vrMungedNames;
+static uint32 vrMungedNamesSize;
+
+static char *vrOutput; /* Text waiting to be written to vrFile */
+static uint32 vrOutputPos;
+static char *vrNameBuffer;
+static uint32 vrNameBufferSize;
+
+/*--------------------------------------------------------------------------------------------------
+  A perfect hash of the Verilog keywords.  A name's hash is its length plus the values below for its
+  first three and last two characters, and no two keywords hash to the same slot.  Characters that
+  do not occur in keywords have the value 255, which pushes the hash past the end of the table.
+--------------------------------------------------------------------------------------------------*/
+static const uint8 vrKeywordAssoValues[256] = {
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+     43,  16, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255,  48,  48,  49,  44,  16,  21,  15,  15,   1,  28,   6,  36,  24,   5,  12,
+     50, 255,   2,  51,  13,  44,  31,  24,  37,  20,   8, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+    255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255
+};
+
+static const char *const vrKeywords[VR_KEYWORD_TABLE_SIZE] = {
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, NULL, NULL, NULL, NULL, NULL, "tri", NULL, NULL, NULL, NULL, NULL, NULL, NULL, "or", NULL,
+    NULL, NULL, NULL, "trior", "nor", "tri1", NULL, NULL, NULL, NULL, NULL, NULL, "integer", NULL,
+    "if", "fork", NULL, "wire", NULL, "join", "for", "trireg", "ifnone", "wor", NULL, NULL, "not",
+    NULL, "forever", "highz1", "rtranif1", NULL, "tri0", NULL, NULL, "reg", "xor", NULL, NULL,
+    "triand", "xnor", "notif1", "negedge", "rtran", NULL, NULL, NULL, NULL, "inout", NULL, "time",
+    NULL, NULL, NULL, "event", NULL, "highz0", "rtranif0", "begin", "wait", NULL, "endfunction",
+    NULL, "function", NULL, "while", "initial", "rnmos", "notif0", NULL, "strength", NULL,
+    "strong1", "force", "endattribute", "tranif1", "nmos", "primitive", "edge", "nand", "attribute",
+    NULL, "realtime", "weak1", "endspecify", "end", "input", NULL, "tran", NULL, "large", NULL,
+    "endprimitive", "endtable", "endmodule", "parameter", "release", "endtask", "wand", "strong0",
+    "output", "signed", "tranif0", "repeat", "deassign", "default", "module", "endcase", NULL, NULL,
+    "weak0", "rcmos", "rpmos", NULL, NULL, NULL, NULL, "and", NULL, "posedge", "cmos", "pmos",
+    "real", "disable", "bufif1", NULL, "medium", NULL, NULL, "defparam", NULL, NULL, "vectored",
+    "specify", "table", "pulldown", "unsigned", NULL, NULL, NULL, NULL, "task", "else", NULL,
+    "assign", "casez", NULL, NULL, NULL, "buf", NULL, "bufif0", "macromodule", "always", NULL,
+    "pull1", "supply1", NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, "specparam", NULL,
+    "small", NULL, NULL, NULL, NULL, NULL, "casex", NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+    "pull0", "supply0", "scalared", NULL, NULL, "case", NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+    NULL, NULL, NULL, "pullup"
+};
+
+/*--------------------------------------------------------------------------------------------------
+  Write the buffered text to vrFile.
+--------------------------------------------------------------------------------------------------*/
+static void flushOutput(void)
+{
+    if(vrOutputPos > 0) {
+        fwrite(vrOutput, 1, vrOutputPos, vrFile);
+        vrOutputPos = 0;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add text to the buffer, writing it out when the buffer fills up.
+--------------------------------------------------------------------------------------------------*/
+static void emit(
+    char *text,
+    uint32 length)
+{
+    if(vrOutputPos + length > VR_OUTPUT_SIZE) {
+        flushOutput();
+        if(length > VR_OUTPUT_SIZE) {
+            fwrite(text, 1, length, vrFile);
+            return;
+        }
+    }
+    memcpy(vrOutput + vrOutputPos, text, length);
+    vrOutputPos += length;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Add a fragment of text to the buffer.  If it does not fit before VR_WRAP_COLUMN, start a new line
+  with newLineText first.  The column after a wrap counts the '\n' too, as it always has, so that
+  the output does not change.
+--------------------------------------------------------------------------------------------------*/
+static void addFragment(
+    char *newLineText,
+    char *text,
+    bool endLine)
+{
+    uint32 length = strlen(text);
+    uint32 newLineLength;
+
+    if(length + vrLinePos > VR_WRAP_COLUMN) {
+        newLineLength = strlen(newLineText);
+        emit("\n", 1);
+        emit(newLineText, newLineLength);
+        vrLinePos = newLineLength + 1;
+    }
+    emit(text, length);
+    if(endLine) {
+        emit("\n", 1);
+        vrLinePos = 0;
+    } else {
+        vrLinePos += length;
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Print the string, starting a new line with newLineText if there is not enough space.  This is
+  the same as vrPrint(newLineText, "%s", string), without formatting.
+--------------------------------------------------------------------------------------------------*/
+static void printString(
+    char *newLineText,
+    char *string)
+{
+    addFragment(newLineText, string, false);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Call printString, and print a new line.
+--------------------------------------------------------------------------------------------------*/
+static void printStringLn(
+    char *newLineText,
+    char *string)
+{
+    addFragment(newLineText, string, true);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Print prefix, name and suffix as one fragment.  This is the same as vrPrint(newLineText,
+  "<prefix>%s<suffix>", name), without formatting.
+--------------------------------------------------------------------------------------------------*/
+static void printName(
+    char *newLineText,
+    char *prefix,
+    char *name,
+    char *suffix)
+{
+    uint32 prefixLength = strlen(prefix);
+    uint32 nameLength = strlen(name);
+    uint32 suffixLength = strlen(suffix);
+    uint32 length = prefixLength + nameLength + suffixLength + 1;
+
+    if(length > vrNameBufferSize) {
+        vrNameBufferSize = length << 1;
+        utResizeArray(vrNameBuffer, vrNameBufferSize);
+    }
+    memcpy(vrNameBuffer, prefix, prefixLength);
+    memcpy(vrNameBuffer + prefixLength, name, nameLength);
+    memcpy(vrNameBuffer + prefixLength + nameLength, suffix, suffixLength + 1);
+    addFragment(newLineText, vrNameBuffer, false);
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -151,15 +201,11 @@ void vrPrint(
 {
     char *buf;
     va_list ap;
-    uint32 length;
 
     va_start(ap, format);
     buf = utVsprintf(format, ap);
-    length = strlen(buf);
-    if(length + vrLinePos > VR_WRAP_COLUMN) {
-        vrLinePos = fprintf(vrFile, "\n%s", newLineText);
-    }
-    vrLinePos += fprintf(vrFile, "%s", buf);
+    va_end(ap);
+    addFragment(newLineText, buf, false);
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -172,16 +218,11 @@ void vrPrintLn(
 {
     char *buf;
     va_list ap;
-    uint32 length;
 
     va_start(ap, format);
     buf = utVsprintf(format, ap);
-    length = strlen(buf);
-    if(length + vrLinePos > VR_WRAP_COLUMN) {
-        fprintf(vrFile, "\n%s", newLineText);
-    }
-    fprintf(vrFile, "%s\n", buf);
-    vrLinePos = 0;
+    va_end(ap);
+    addFragment(newLineText, buf, true);
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -210,10 +251,24 @@ static bool nameHasIllegalChars(
 static bool stringIsKeyword(
     char *string)
 {
-    if(htHtblLookupSym(vrKeywordTable, utSymCreate(string)) != utSymNull) {
-        return true;
+    uint32 length = strlen(string);
+    uint32 hash;
+    const char *keyword;
+
+    if(length < VR_MIN_KEYWORD_LENGTH || length > VR_MAX_KEYWORD_LENGTH) {
+        return false;
     }
-    return false;
+    hash = length + vrKeywordAssoValues[(uint8)string[0]] + vrKeywordAssoValues[(uint8)string[1]] +
+        vrKeywordAssoValues[(uint8)string[length - 2]] +
+        vrKeywordAssoValues[(uint8)string[length - 1]];
+    if(length > 2) {
+        hash += vrKeywordAssoValues[(uint8)string[2]];
+    }
+    if(hash >= VR_KEYWORD_TABLE_SIZE) {
+        return false;
+    }
+    keyword = vrKeywords[hash];
+    return keyword != NULL && !strcmp(keyword, string);
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -234,6 +289,63 @@ char *vrMunge(
     return name;
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Start remembering the munged names of symbols.
+--------------------------------------------------------------------------------------------------*/
+static void startMungedNames(void)
+{
+    vrMungedNamesSize = 1024;
+    vrMungedNames = utNewA(char *, vrMungedNamesSize);
+    memset(vrMungedNames, 0, vrMungedNamesSize*sizeof(char *));
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Free the munged names of symbols.
+--------------------------------------------------------------------------------------------------*/
+static void stopMungedNames(void)
+{
+    char *name;
+    uint32 xSym;
+
+    for(xSym = 0; xSym < vrMungedNamesSize; xSym++) {
+        name = vrMungedNames[xSym];
+        if(name != NULL && name != utSymGetName(utIndex2Sym(xSym))) {
+            utFree(name);
+        }
+    }
+    utFree(vrMungedNames);
+    vrMungedNames = NULL;
+    vrMungedNamesSize = 0;
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Return the Verilog name of a symbol.  Each symbol is only munged the first time it is written.
+--------------------------------------------------------------------------------------------------*/
+static char *mungeSym(
+    utSym sym)
+{
+    uint32 xSym = utSym2Index(sym);
+    uint32 oldSize;
+    char *name, *mungedName;
+
+    if(xSym >= vrMungedNamesSize) {
+        oldSize = vrMungedNamesSize;
+        vrMungedNamesSize = xSym + (xSym >> 1) + 1;
+        utResizeArray(vrMungedNames, vrMungedNamesSize);
+        memset(vrMungedNames + oldSize, 0, (vrMungedNamesSize - oldSize)*sizeof(char *));
+    }
+    mungedName = vrMungedNames[xSym];
+    if(mungedName == NULL) {
+        name = utSymGetName(sym);
+        mungedName = vrMunge(name);
+        if(mungedName != name) {
+            mungedName = utAllocString(mungedName);
+        }
+        vrMungedNames[xSym] = mungedName;
+    }
+    return mungedName;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Return a name for a direction..
 --------------------------------------------------------------------------------------------------*/
@@ -256,7 +368,7 @@ static char *getDirectionName(
 static void writeMportParameter(
     dbMport mport)
 {
-    vrPrint("   ", "%s", vrMunge(dbMportGetName(mport)));
+    printString("   ", mungeSym(dbMportGetSym(mport)));
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -265,7 +377,7 @@ static void writeMportParameter(
 static void writeMbusParameter(
     dbMbus mbus)
 {
-    vrPrint("   ", "%s", vrMunge(dbMbusGetName(mbus)));
+    printString("   ", mungeSym(dbMbusGetSym(mbus)));
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -282,12 +394,12 @@ static void writeMportParameters(
         mbus = dbMportGetMbus(mport);
         if(mbus == dbMbusNull) {
             if(!isFirst) {
-                vrPrint("   ", ", ");
+                printString("   ", ", ");
             }
             writeMportParameter(mport);
         } else if(mbus != pMbus) {
             if(!isFirst) {
-                vrPrint("   ", ", ");
+                printString("   ", ", ");
             }
             writeMbusParameter(mbus);
             pMbus = mbus;
@@ -302,9 +414,9 @@ static void writeMportParameters(
 static void writeNetlistHeader(
     dbNetlist netlist)
 {
-    vrPrint("", "module %s (", vrMunge(dbNetlistGetName(netlist)));
+    printName("", "module ", mungeSym(dbNetlistGetSym(netlist)), " (");
     writeMportParameters(netlist);
-    vrPrintLn("   ", ");");
+    printStringLn("   ", ");");
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -322,7 +434,7 @@ static char *vrMungeNetName(
             return "1'b0";
         }
     }
-    return vrMunge(dbNetGetName(net));
+    return mungeSym(dbNetGetSym(net));
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -331,7 +443,7 @@ static char *vrMungeNetName(
 static char *vrMungeMportName(
     dbMport mport)
 {
-    return vrMunge(dbMportGetName(mport));
+    return mungeSym(dbMportGetSym(mport));
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -350,8 +462,8 @@ static void writeMbusDeclarations(
         if(dbFindMportTypeDirection(dbMbusGetType(mbus)) == direction) {
             vrPrint("", "%s [%u:%u] %s",
                      getDirectionName(direction), left, right,
-                     vrMunge(dbMbusGetName(mbus)));
-            vrPrintLn("   ", ";");
+                     mungeSym(dbMbusGetSym(mbus)));
+            printStringLn("   ", ";");
         }
     } dbEndNetlistMbus;
 }
@@ -370,17 +482,17 @@ static void writeMportDeclarations(
         if(dbMportGetMbus(mport) == dbMbusNull) {
             if(dbFindMportTypeDirection(dbMportGetType(mport)) == direction) {
                 if(isFirst) {
-                    vrPrint("", "%s ", getDirectionName(direction));
+                    printName("", "", getDirectionName(direction), " ");
                 } else {
-                    vrPrint("   ", ", ");
+                    printString("   ", ", ");
                 }
                 isFirst = false;
-                vrPrint("   ", "%s", vrMunge(dbMportGetName(mport)));
+                printString("   ", mungeSym(dbMportGetSym(mport)));
             }
         }
     } dbEndNetlistMport;
     if(!isFirst) {
-        vrPrintLn("   ", ";");
+        printStringLn("   ", ";");
     }
 }
 
@@ -400,8 +512,8 @@ static void writeBusDeclarations(
         right = dbBusGetRight(bus);
         if(mbus == dbMbusNull) {
             vrPrint("", "wire [%u:%u] %s", left, right,
-                     vrMunge(dbBusGetName(bus)));
-            vrPrintLn("   ", ";");
+                     mungeSym(dbBusGetSym(bus)));
+            printStringLn("   ", ";");
         }
     } dbEndNetlistBus;
 }
@@ -421,17 +533,17 @@ static void writeNetDeclarations(
             mport = dbNetlistFindMport(netlist, dbNetGetSym(net));
             if(mport == dbMportNull) {
                 if(isFirst) {
-                    vrPrint("", "wire ");
+                    printString("", "wire ");
                 } else {
-                    vrPrint("   ", ", ");
+                    printString("   ", ", ");
                 }
                 isFirst = false;
-                vrPrint("   ", "%s", vrMungeNetName(net));
+                printString("   ", vrMungeNetName(net));
             }
         }
     } dbEndNetlistNet;
     if(!isFirst) {
-        vrPrintLn("   ", ";");
+        printStringLn("   ", ";");
     }
 }
 
@@ -449,7 +561,7 @@ static void writeNetlistDeclarations(
     writeMportDeclarations(netlist, DB_INOUT);
     writeBusDeclarations(netlist);
     writeNetDeclarations(netlist);
-    vrPrintLn("", "");
+    printStringLn("", "");
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -473,9 +585,9 @@ static void writeConnectionName(
             leftIndex = right + (left - right) - leftIndex;
             rightIndex = right + (left - right) - rightIndex;
         }
-        vrPrint("      ", "%s[%u:%u]", vrMunge(dbBusGetName(bus)), leftIndex, rightIndex);
+        vrPrint("      ", "%s[%u:%u]", mungeSym(dbBusGetSym(bus)), leftIndex, rightIndex);
     } else {
-        vrPrint("      ", "%s", vrMungeNetName(net));
+        printString("      ", vrMungeNetName(net));
     }
 }
 
@@ -501,9 +613,9 @@ static void writeBusConnection(
         if(pNet != dbNetNull && (pBus == dbBusNull || pBus != bus ||
                 utAbs((int32)dbNetGetBusIndex(net) - (int32)rightIndex) != 1)) {
             if(firstBus) {
-                vrPrint("      ", "{");
+                printString("      ", "{");
             } else {
-                vrPrint("      ", ", ");
+                printString("      ", ", ");
             }
             firstBus = false;
             writeConnectionName(pNet, leftIndex, rightIndex);
@@ -519,11 +631,11 @@ static void writeBusConnection(
         pNet = net;
     } dbEndMbusMport;
     if(!firstBus) {
-        vrPrint("      ", ", ");
+        printString("      ", ", ");
     }
     writeConnectionName(pNet, leftIndex, rightIndex);
     if(!firstBus) {
-        vrPrint("      ", "}");
+        printString("      ", "}");
     }
 }
 
@@ -540,8 +652,8 @@ static void writeNetlistInst(
     dbMbus pMbus = dbMbusNull, mbus;
     bool isFirst = true; 
 
-    vrPrint("", "   %s ", vrMunge(dbNetlistGetName(internalNetlist)));
-    vrPrint("      ", "%s(", vrMunge(dbInstGetUserName(inst)));
+    printName("", "   ", mungeSym(dbNetlistGetSym(internalNetlist)), " ");
+    printName("      ", "", mungeSym(dbInstGetSym(inst)), "(");
     dbForeachNetlistMport(internalNetlist, mport) {
         port = dbFindPortFromInstMport(inst, mport);
         net = dbPortGetNet(port);
@@ -550,22 +662,22 @@ static void writeNetlistInst(
             mbus = dbMportGetMbus(mport);
             if(mbus == dbMbusNull || mbus != pMbus) {
                 if(!isFirst) {
-                    vrPrint("      ", ", ");
+                    printString("      ", ", ");
                 }
                 isFirst = false;
                 if(mbus == dbMbusNull) {
-                    vrPrint("      ", ".%s(", vrMunge(dbMportGetName(mport)));
-                    vrPrint("      ", "%s", vrMungeNetName(net));
+                    printName("      ", ".", mungeSym(dbMportGetSym(mport)), "(");
+                    printString("      ", vrMungeNetName(net));
                 } else {
-                    vrPrint("      ", ".%s(", vrMunge(dbMbusGetName(mbus)));
+                    printName("      ", ".", mungeSym(dbMbusGetSym(mbus)), "(");
                     writeBusConnection(inst, mbus);
                     pMbus = mbus;
                 }
-                vrPrint("      ", ")");
+                printString("      ", ")");
             }
         }
     } dbEndNetlistMport;
-    vrPrintLn("      ", ");");
+    printStringLn("      ", ");");
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -628,7 +740,7 @@ static void writeNetlist(
     writeNetlistDeclarations(netlist);
     writeNetlistInstances(netlist);
     writeMportAssignments(netlist);
-    vrPrintLn("", "endmodule\n");
+    printStringLn("", "endmodule\n");
 }
 
 /*--------------------------------------------------------------------------------------------------
@@ -671,6 +783,33 @@ static void writeNetlists(
     }
 }
 
+/*--------------------------------------------------------------------------------------------------
+  Start writing to vrFile.
+--------------------------------------------------------------------------------------------------*/
+static void startWriting(void)
+{
+    vrOutput = utNewA(char, VR_OUTPUT_SIZE);
+    vrOutputPos = 0;
+    vrLinePos = 0;
+    startMungedNames();
+    vrNameBufferSize = 256;
+    vrNameBuffer = utNewA(char, vrNameBufferSize);
+}
+
+/*--------------------------------------------------------------------------------------------------
+  Write out what is left in the buffer, and free it.
+--------------------------------------------------------------------------------------------------*/
+static void stopWriting(void)
+{
+    flushOutput();
+    utFree(vrOutput);
+    vrOutput = NULL;
+    stopMungedNames();
+    utFree(vrNameBuffer);
+    vrNameBuffer = NULL;
+    vrNameBufferSize = 0;
+}
+
 /*--------------------------------------------------------------------------------------------------
   Write a verilog gate level design.
 --------------------------------------------------------------------------------------------------*/
@@ -684,10 +823,9 @@ bool vrWriteDesign(
     if(!vrFile) {
         return false;
     }
-    vrLinePos = 0;
-    buildKeywordTable();
+    startWriting();
     writeNetlists(design, wholeLibrary);
-    htHtblDestroy(vrKeywordTable);
+    stopWriting();
     fclose(vrFile);
     return true;
 }
@@ -704,10 +842,9 @@ bool vrWriteNetlist(
     if(!vrFile) {
         return false;
     }
-    vrLinePos = 0;
-    buildKeywordTable();
+    startWriting();
     writeNetlist(netlist);
-    htHtblDestroy(vrKeywordTable);
+    stopWriting();
     fclose(vrFile);
     return true;
 }
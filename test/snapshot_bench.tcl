@@ -0,0 +1,25 @@
+# Compare the text database format with binary snapshots.  Run from this directory with:
+#
+#     gnetman snapshot_bench.tcl
+#
+# Set the environment variable BENCH_SCHEMATIC to benchmark a different schematic.
+
+set schemName reg32.sch
+if {[info exists env(BENCH_SCHEMATIC)]} {
+    set schemName $env(BENCH_SCHEMATIC)
+}
+set iterations 5
+read_netlist schematic bench $schemName
+
+proc report {label usec} {
+    global iterations
+    puts [format "%-16s %10.1f ms" $label [expr {$usec / 1000.0 / $iterations}]]
+}
+
+report "text save" [lindex [time {save_database bench.db} $iterations] 0]
+report "text load" [lindex [time {load_database bench.db} $iterations] 0]
+report "snapshot save" [lindex [time {save_snapshot bench.snap} $iterations] 0]
+report "snapshot load" [lindex [time {load_snapshot bench.snap} $iterations] 0]
+puts [format "%-16s %10d bytes" "text size" [file size bench.db]]
+puts [format "%-16s %10d bytes" "snapshot size" [file size bench.snap]]
+file delete bench.db bench.snap